@@ -34,8 +34,51 @@ namespace UnrealBuildTool.Rules
 				PublicIncludePaths.Add(Path.Combine(ACLSDKDir, "acl/external/sjson-cpp/includes"));
 			}
 
+			// The format manifest is generated when cooking, it lists the formats used by the project's ACL content
+			// and allows the ACLCustom decoders to be compiled with only those enabled. See ACLFormatManifest.h
+			string FormatManifestPath = Target.ProjectFile != null ? Path.Combine(Target.ProjectFile.Directory.FullName, "Config", "ACLFormatManifest.ini") : null;
+			if (FormatManifestPath != null && File.Exists(FormatManifestPath))
+			{
+				PrivateDefinitions.Add("ACL_WITH_FORMAT_MANIFEST=1");
+
+				foreach (string Line in File.ReadAllLines(FormatManifestPath))
+				{
+					string[] KeyValue = Line.Split('=');
+					if (KeyValue.Length != 2)
+					{
+						continue;
+					}
+
+					string Key = KeyValue[0].Trim();
+					string Prefix = Key == "RotationFormats" ? "ROTATION" : Key == "TranslationFormats" ? "TRANSLATION" : Key == "ScaleFormats" ? "SCALE" : null;
+					if (Prefix == null)
+					{
+						continue;
+					}
+
+					foreach (string Format in KeyValue[1].Split(','))
+					{
+						if (Format.Trim().Length != 0)
+						{
+							PrivateDefinitions.Add("ACL_MANIFEST_" + Prefix + "_" + Format.Trim().ToUpperInvariant() + "=1");
+						}
+					}
+				}
+			}
+			else
+			{
+				PrivateDefinitions.Add("ACL_WITH_FORMAT_MANIFEST=0");
+			}
+
 			if (Target.Platform == UnrealTargetPlatform.Linux)
 			{
+				// The decoders built for each instruction set rename the ACL symbols with macros and cannot share
+				// a unity translation unit, see ACLDecompressionKernelsISA.inl. They are only built without the editor.
+				if (!Target.bBuildEditor)
+				{
+					bUseUnity = false;
+				}
+
 				// There appears to be a bug when cross-compiling Linux under Windows where the clang tool-chain used
 				// isn't fully C++11 compliant. The standard specifies that when the 'cinttypes' header is included
 				// the format macros are always defined unlike C which requires the following macro to be defined first.
@@ -29,11 +29,17 @@ public:
 	bool PerformExhaustiveDump;
 	bool PerformCompression;
 	bool PerformClipExtraction;
+	bool PerformLoadBenchmark;
+	bool PerformDecompressionBenchmark;
+	bool PerformSettingsSweep;
 	bool TryAutomaticCompression;
 	bool TryACLCompression;
 	bool TryKeyReductionRetarget;
 	bool TryKeyReduction;
+	bool TryCurveCompression;
 	bool ResumeTask;
+	bool CompressOutput;
+	bool BinaryErrorOutput;
 	bool SkipAdditiveClips;
 
 	class UAnimBoneCompressionSettings* AutoCompressionSettings;
@@ -41,5 +47,8 @@ public:
 	class UAnimBoneCompressionSettings* KeyReductionCompressionSettings;
 	class UAnimBoneCompressionCodec_ACL* ACLCodec;
 	class UAnimCompress_RemoveLinearKeys* KeyReductionCodec;
+
+	TArray<float> SweepErrorThresholds;
+	TArray<float> SweepVirtualVertexDistances;
 #endif
 };
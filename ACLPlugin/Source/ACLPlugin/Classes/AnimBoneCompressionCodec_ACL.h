@@ -25,6 +25,22 @@ class UAnimBoneCompressionCodec_ACL : public UAnimBoneCompressionCodec_ACLBase
 	UPROPERTY(EditAnywhere, Category = "ACL Options")
 	TArray<class USkeletalMesh*> OptimizationTargets;
 
+	/** Whether to replace bones that no skinned vertex or socket of the optimization targets depends on by their bind pose. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options")
+	bool bStripUnusedBones;
+
+	/** Whether to use a looser precision for bones that are removed from the lower LODs of the optimization targets. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options")
+	bool bUseLODBonePrecision;
+
+	/** The error threshold multiplier applied for every mesh LOD a bone is missing from. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options", meta = (ClampMin = "1", EditCondition = "bUseLODBonePrecision"))
+	float LODBoneErrorThresholdScale;
+
+	/** The virtual vertex distance multiplier applied for every mesh LOD a bone is missing from. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options", meta = (ClampMin = "0.01", ClampMax = "1", EditCondition = "bUseLODBonePrecision"))
+	float LODBoneShellDistanceScale;
+
 	//////////////////////////////////////////////////////////////////////////
 	// UObject implementation
 	virtual void PostInitProperties() override;
@@ -37,6 +53,8 @@ class UAnimBoneCompressionCodec_ACL : public UAnimBoneCompressionCodec_ACLBase
 	// UAnimBoneCompressionCodec_ACLBase implementation
 	virtual void GetCompressionSettings(acl::compression_settings& OutSettings) const override;
 	virtual TArray<class USkeletalMesh*> GetOptimizationTargets() const override { return OptimizationTargets; }
+	virtual bool ShouldStripUnusedBones() const override { return bStripUnusedBones; }
+	virtual bool GetLODBonePrecision(float& OutErrorThresholdScale, float& OutShellDistanceScale) const override;
 	virtual ACLSafetyFallbackResult ExecuteSafetyFallback(acl::iallocator& Allocator, const acl::compression_settings& Settings, const acl::track_array_qvvf& RawClip, const acl::track_array_qvvf& BaseClip, const acl::compressed_tracks& CompressedClipData, const FCompressibleAnimData& CompressibleAnimData, FCompressibleAnimDataResult& OutResult);
 #endif
 
@@ -5,6 +5,10 @@
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
 #include "Animation/AnimBoneCompressionCodec.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+// Decompression telemetry is only gathered in development builds
+#define WITH_ACL_TELEMETRY (!UE_BUILD_SHIPPING)
 
 #if WITH_EDITORONLY_DATA
 #include <acl/compression/compression_settings.h>
@@ -43,6 +47,15 @@ enum ACLCompressionLevel
 	ACLCL_Highest UMETA(DisplayName = "Highest"),
 };
 
+/** An enum for ACL memory budget modes. */
+UENUM()
+enum ACLMemoryBudgetMode
+{
+	ACLMBM_Disabled UMETA(DisplayName = "Disabled"),
+	ACLMBM_BytesPerSequence UMETA(DisplayName = "Bytes Per Sequence"),
+	ACLMBM_BytesPerSecond UMETA(DisplayName = "Bytes Per Second"),
+};
+
 /** An enum that represents the result of attempting to use a safety fallback codec. */
 enum class ACLSafetyFallbackResult
 {
@@ -51,14 +64,76 @@ enum class ACLSafetyFallbackResult
 	Ignored,	// No safety fallback used
 };
 
+#if WITH_ACL_TELEMETRY
+/** Whether decompression telemetry is gathered, controlled with the ACL.EnableTelemetry console variable. */
+extern int32 GACLEnableTelemetry;
+
+/** Decompression statistics of a single anim sequence, every thread that decompresses it updates them atomically. */
+struct FACLDecompressionTelemetry
+{
+	FThreadSafeCounter64 NumDecompressionCalls;
+	FThreadSafeCounter64 DecompressionCycles;
+	FThreadSafeCounter64 NumBytesTouched;
+	FThreadSafeCounter64 LastUsedFrame;
+
+	void Reset()
+	{
+		NumDecompressionCalls.Reset();
+		DecompressionCycles.Reset();
+		NumBytesTouched.Reset();
+		LastUsedFrame.Reset();
+	}
+};
+#endif
+
 struct FACLCompressedAnimData final : public ICompressedAnimData
 {
+	/** The ACL compressed bone data. */
 	TArrayView<uint8> CompressedByteStream;
 
+	/** The ACL compressed curve data when it is stored in the same buffer as the bone data, empty otherwise. */
+	TArrayView<uint8> CompressedCurveByteStream;
+
+	/** Where the curve data lives in the bulk data, the bone data always starts at offset 0. */
+	uint32 CompressedCurveOffset = 0;
+	uint32 CompressedCurveSize = 0;
+
+	/** Whether the bone data and the curve data stored with it are valid, validated once when bound instead of on every decompression call. */
+	bool bIsBoneDataValid = false;
+	bool bIsCurveDataValid = false;
+
+	/** A unique identifier assigned every time the data is bound, cached poses are keyed by it and are never shared with stale data. */
+	uint32 BindId = 0;
+
+	/** Whether the bone data only uses formats from the cooked format manifest, evaluated once when bound. */
+	bool bIsSupportedByFormatManifest = false;
+
+	/** Whether the bulk data is being loaded, the engine binds it before its bytes are read and they are only validated once they are. */
+	bool bIsLoadingBulkData = false;
+
+#if WITH_EDITOR
+	/** Whether the formats used are added to the format manifest when cooked, only the ACLCustom codec decodes with the manifest. */
+	bool bRecordFormatUsage = false;
+#endif
+
+#if WITH_ACL_TELEMETRY
+	/** Decompression statistics reported by the ACL.Telemetry console command. */
+	mutable FACLDecompressionTelemetry Telemetry;
+#endif
+
+#if WITH_EDITORONLY_DATA
+	/** The error threshold used to compress, it differs from the codec value when a memory budget is used. */
+	float ErrorThreshold = 0.0f;
+#endif
+
 	// ICompressedAnimData implementation
-	virtual void Bind(const TArrayView<uint8> BulkData) override { CompressedByteStream = BulkData; }
-	virtual int64 GetApproxCompressedSize() const override { return CompressedByteStream.Num(); }
-	virtual bool IsValid() const override;
+	virtual void SerializeCompressedData(FArchive& Ar) override;
+	virtual void Bind(const TArrayView<uint8> BulkData) override;
+	virtual int64 GetApproxCompressedSize() const override { return CompressedByteStream.Num() + CompressedCurveByteStream.Num(); }
+	virtual bool IsValid() const override { return bIsBoneDataValid; }
+
+	/** Validates the bound data once its bytes are in place. */
+	void Validate();
 };
 
 /** The base codec implementation for ACL support. */
@@ -81,9 +156,29 @@ class UAnimBoneCompressionCodec_ACLBase : public UAnimBoneCompressionCodec
 	float SafeVirtualVertexDistance;
 
 	/** The error threshold to use when optimizing and compressing the animation sequence. */
-	UPROPERTY(EditAnywhere, Category = "ACL Options", meta = (ClampMin = "0"))
+	UPROPERTY(EditAnywhere, Category = "ACL Options", meta = (ClampMin = "0", EditCondition = "MemoryBudgetMode == ACLMBM_Disabled"))
 	float ErrorThreshold;
 
+	/** Whether to search for the lowest error threshold that fits within a memory budget instead of using a fixed error threshold. */
+	UPROPERTY(EditAnywhere, Category = "Memory Budget")
+	TEnumAsByte<ACLMemoryBudgetMode> MemoryBudgetMode;
+
+	/** The memory budget in bytes for the whole sequence or for every second of animation. */
+	UPROPERTY(EditAnywhere, Category = "Memory Budget", meta = (ClampMin = "1", EditCondition = "MemoryBudgetMode != ACLMBM_Disabled"))
+	int32 MemoryBudget;
+
+	/** The lowest error threshold the memory budget search can select. */
+	UPROPERTY(EditAnywhere, Category = "Memory Budget", meta = (ClampMin = "0", EditCondition = "MemoryBudgetMode != ACLMBM_Disabled"))
+	float MinErrorThreshold;
+
+	/** The highest error threshold the memory budget search can select. */
+	UPROPERTY(EditAnywhere, Category = "Memory Budget", meta = (ClampMin = "0", EditCondition = "MemoryBudgetMode != ACLMBM_Disabled"))
+	float MaxErrorThreshold;
+
+	/** The maximum number of times the sequence is compressed while searching for the error threshold. */
+	UPROPERTY(EditAnywhere, Category = "Memory Budget", meta = (ClampMin = "2", ClampMax = "32", EditCondition = "MemoryBudgetMode != ACLMBM_Disabled"))
+	int32 MaxNumMemoryBudgetIterations;
+
 	// UAnimBoneCompressionCodec implementation
 	virtual bool Compress(const FCompressibleAnimData& CompressibleAnimData, FCompressibleAnimDataResult& OutResult) override;
 	virtual void PopulateDDCKey(FArchive& Ar) override;
@@ -91,7 +186,12 @@ class UAnimBoneCompressionCodec_ACLBase : public UAnimBoneCompressionCodec
 	// Our implementation
 	virtual void GetCompressionSettings(acl::compression_settings& OutSettings) const PURE_VIRTUAL(UAnimBoneCompressionCodec_ACLBase::GetCompressionSettings, );
 	virtual TArray<class USkeletalMesh*> GetOptimizationTargets() const { return TArray<class USkeletalMesh*>(); }
+	virtual bool ShouldStripUnusedBones() const { return false; }
+	virtual bool GetLODBonePrecision(float& OutErrorThresholdScale, float& OutShellDistanceScale) const { return false; }
 	virtual ACLSafetyFallbackResult ExecuteSafetyFallback(acl::iallocator& Allocator, const acl::compression_settings& Settings, const acl::track_array_qvvf& RawClip, const acl::track_array_qvvf& BaseClip, const acl::compressed_tracks& CompressedClipData, const FCompressibleAnimData& CompressibleAnimData, FCompressibleAnimDataResult& OutResult);
+
+	/** Adds the bones with a socket to the DDC key, along with the skinned bones they determine which bones are stripped. */
+	static void PopulateSocketBonesDDCKey(FArchive& Ar, const TArray<class USkeletalMesh*>& OptimizationTargets);
 #endif
 
 	// UAnimBoneCompressionCodec implementation
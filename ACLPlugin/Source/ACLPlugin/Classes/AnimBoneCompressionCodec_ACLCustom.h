@@ -50,6 +50,22 @@ class UAnimBoneCompressionCodec_ACLCustom : public UAnimBoneCompressionCodec_ACL
 	UPROPERTY(EditAnywhere, Category = "ACL Options")
 	TArray<class USkeletalMesh*> OptimizationTargets;
 
+	/** Whether to replace bones that no skinned vertex or socket of the optimization targets depends on by their bind pose. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options")
+	bool bStripUnusedBones;
+
+	/** Whether to use a looser precision for bones that are removed from the lower LODs of the optimization targets. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options")
+	bool bUseLODBonePrecision;
+
+	/** The error threshold multiplier applied for every mesh LOD a bone is missing from. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options", meta = (ClampMin = "1", EditCondition = "bUseLODBonePrecision"))
+	float LODBoneErrorThresholdScale;
+
+	/** The virtual vertex distance multiplier applied for every mesh LOD a bone is missing from. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options", meta = (ClampMin = "0.01", ClampMax = "1", EditCondition = "bUseLODBonePrecision"))
+	float LODBoneShellDistanceScale;
+
 	//////////////////////////////////////////////////////////////////////////
 
 	// UAnimBoneCompressionCodec implementation
@@ -58,6 +74,13 @@ class UAnimBoneCompressionCodec_ACLCustom : public UAnimBoneCompressionCodec_ACL
 	// UAnimBoneCompressionCodec_ACLBase implementation
 	virtual void GetCompressionSettings(acl::compression_settings& OutSettings) const override;
 	virtual TArray<class USkeletalMesh*> GetOptimizationTargets() const override { return OptimizationTargets; }
+	virtual bool ShouldStripUnusedBones() const override { return bStripUnusedBones; }
+	virtual bool GetLODBonePrecision(float& OutErrorThresholdScale, float& OutShellDistanceScale) const override;
+#endif
+
+#if WITH_EDITOR
+	// UAnimBoneCompressionCodec implementation
+	virtual TUniquePtr<ICompressedAnimData> AllocateAnimData() const override;
 #endif
 
 	// UAnimBoneCompressionCodec implementation
@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
 #include "Animation/AnimCurveCompressionCodec.h"
+
+#if WITH_EDITORONLY_DATA
+#include <acl/compression/compression_settings.h>
+#endif
+
 #include "AnimCurveCompressionCodec_ACL.generated.h"
 
 /** The default codec implementation for ACL curve compression support with the minimal set of exposed features for ease of use. */
@@ -26,10 +31,23 @@ class UAnimCurveCompressionCodec_ACL : public UAnimCurveCompressionCodec
 	UPROPERTY(EditAnywhere, Category = "ACL Options")
 	class USkeletalMesh* MorphTargetSource;
 
+	/** Whether to store the compressed curves in the same buffer as the bone data. Only used when every bone codec is an ACL codec. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options")
+	bool bStoreWithBoneData;
+
 	//////////////////////////////////////////////////////////////////////////
 	// UAnimCurveCompressionCodec implementation
 	virtual void PopulateDDCKey(FArchive& Ar) override;
 	virtual bool Compress(const FCompressibleAnimData& AnimSeq, FAnimCurveCompressionResult& OutResult) override;
+
+	// Our implementation
+	virtual void GetCompressionSettings(acl::compression_settings& OutSettings) const;
+
+	/** Compresses the curves and returns the ACL compressed data. */
+	bool CompressCurves(const FCompressibleAnimData& AnimSeq, TArray<uint8>& OutCompressedBytes) const;
+
+	/** Returns whether the compressed curves are stored with the bone data instead of in their own stream. */
+	bool IsStoredWithBoneData(const FCompressibleAnimData& AnimSeq) const;
 #endif
 
 	// UAnimCurveCompressionCodec implementation
@@ -0,0 +1,29 @@
+#pragma once
+
+// Copyright 2020 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "AnimBoneCompressionCodec_ACLBase.h"
+#include "AnimCurveCompressionCodec_ACL.h"
+#include "AnimCurveCompressionCodec_ACLCustom.generated.h"
+
+/** The custom codec implementation for ACL curve compression support with all features supported. */
+UCLASS(MinimalAPI, config = Engine, meta = (DisplayName = "ACL Curves Custom"))
+class UAnimCurveCompressionCodec_ACLCustom : public UAnimCurveCompressionCodec_ACL
+{
+	GENERATED_UCLASS_BODY()
+
+#if WITH_EDITORONLY_DATA
+	/** The compression level to use. Higher levels will be slower to compress but yield a lower memory footprint. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options")
+	TEnumAsByte<ACLCompressionLevel> CompressionLevel;
+
+	//////////////////////////////////////////////////////////////////////////
+	// UAnimCurveCompressionCodec implementation
+	virtual void PopulateDDCKey(FArchive& Ar) override;
+
+	// UAnimCurveCompressionCodec_ACL implementation
+	virtual void GetCompressionSettings(acl::compression_settings& OutSettings) const override;
+#endif
+};
@@ -0,0 +1,129 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLBatchDecompression.h"
+
+#include "Animation/AnimSequence.h"
+#include "Animation/AnimBoneCompressionCodec.h"
+#include "Async/ParallelFor.h"
+#include "Misc/MemStack.h"
+
+#include "AnimBoneCompressionCodec_ACLBase.h"
+
+#include <acl/decompression/decompress.h>
+
+/** Returns the ACL segment that contains the sample used at the provided time, or zero if the sequence doesn't use ACL. */
+static uint32 GetSegmentIndex(const UAnimSequence& AnimSeq, float Time)
+{
+	const UAnimBoneCompressionCodec* Codec = AnimSeq.CompressedData.BoneCompressionCodec;
+	if (Codec == nullptr || !Codec->IsA<UAnimBoneCompressionCodec_ACLBase>())
+	{
+		return 0;
+	}
+
+	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(*AnimSeq.CompressedData.CompressedDataStructure);
+	if (!AnimData.IsValid())
+	{
+		return 0;
+	}
+
+	const acl::compressed_tracks* CompressedClipData = acl::make_compressed_tracks(AnimData.CompressedByteStream.GetData());
+	const acl::acl_impl::tracks_header& TracksHeader = acl::acl_impl::get_tracks_header(*CompressedClipData);
+	const acl::acl_impl::transform_tracks_header& TransformHeader = acl::acl_impl::get_transform_tracks_header(*CompressedClipData);
+	if (TransformHeader.num_segments <= 1 || !TransformHeader.segment_start_indices_offset.is_valid())
+	{
+		return 0;
+	}
+
+	const uint32 SampleIndex = uint32(FMath::Max(Time, 0.0f) * TracksHeader.sample_rate);
+	const uint32* SegmentStartIndices = TransformHeader.get_segment_start_indices();
+
+	// Segments are few and sorted, a linear search is plenty
+	uint32 SegmentIndex = 0;
+	while (SegmentIndex + 1 < TransformHeader.num_segments && SegmentStartIndices[SegmentIndex + 1] <= SampleIndex)
+	{
+		SegmentIndex++;
+	}
+
+	return SegmentIndex;
+}
+
+void DecompressPoseAndCurves(const FACLPoseDecompressionRequest& Request)
+{
+	const UAnimSequence* AnimSeq = Request.AnimSeq;
+	check(AnimSeq != nullptr && AnimSeq->CompressedData.CompressedDataStructure.IsValid());
+
+	// Decompression allocates temporary data on the thread's memory stack
+	FMemMark Mark(FMemStack::Get());
+
+	FACLScopedDecompressionQuality ScopedQuality(Request.Quality);
+
+	FAnimSequenceDecompressionContext DecompContext(AnimSeq->SequenceLength, AnimSeq->Interpolation, AnimSeq->GetFName(), *AnimSeq->CompressedData.CompressedDataStructure);
+	DecompContext.Seek(Request.Time);
+
+	TArrayView<FTransform> OutAtoms = Request.OutAtoms;
+	AnimSeq->CompressedData.BoneCompressionCodec->DecompressPose(DecompContext, *Request.RotationPairs, *Request.TranslationPairs, *Request.ScalePairs, OutAtoms);
+
+	if (Request.OutCurves != nullptr)
+	{
+		// Goes through the curve codec like any other curve evaluation, it reads the curves stored with the bone data
+		AnimSeq->EvaluateCurveData(*Request.OutCurves, Request.Time);
+	}
+}
+
+void DecompressPoseBatch(TArrayView<const FACLPoseDecompressionRequest> Requests, int32 NumRequestsPerTask)
+{
+	const int32 NumRequests = Requests.Num();
+	if (NumRequests == 0)
+	{
+		return;
+	}
+
+	struct FSortEntry
+	{
+		const UAnimSequence* AnimSeq;
+		uint32 SegmentIndex;
+		float Time;
+		int32 RequestIndex;
+	};
+
+	TArray<FSortEntry> SortedRequests;
+	SortedRequests.Reserve(NumRequests);
+	for (int32 RequestIndex = 0; RequestIndex < NumRequests; ++RequestIndex)
+	{
+		const FACLPoseDecompressionRequest& Request = Requests[RequestIndex];
+		check(Request.AnimSeq != nullptr && Request.AnimSeq->CompressedData.CompressedDataStructure.IsValid());
+
+		SortedRequests.Add({ Request.AnimSeq, GetSegmentIndex(*Request.AnimSeq, Request.Time), Request.Time, RequestIndex });
+	}
+
+	// Group the poses that read the same compressed data together
+	SortedRequests.Sort([](const FSortEntry& Lhs, const FSortEntry& Rhs)
+		{
+			if (Lhs.AnimSeq != Rhs.AnimSeq)
+			{
+				return Lhs.AnimSeq < Rhs.AnimSeq;
+			}
+
+			if (Lhs.SegmentIndex != Rhs.SegmentIndex)
+			{
+				return Lhs.SegmentIndex < Rhs.SegmentIndex;
+			}
+
+			return Lhs.Time < Rhs.Time;
+		});
+
+	NumRequestsPerTask = FMath::Max(NumRequestsPerTask, 1);
+	const int32 NumTasks = FMath::DivideAndRoundUp(NumRequests, NumRequestsPerTask);
+
+	// Idle workers grab the next task as soon as they are done with their current one
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+		{
+			const int32 FirstEntryIndex = TaskIndex * NumRequestsPerTask;
+			const int32 LastEntryIndex = FMath::Min(FirstEntryIndex + NumRequestsPerTask, NumRequests);
+
+			for (int32 EntryIndex = FirstEntryIndex; EntryIndex < LastEntryIndex; ++EntryIndex)
+			{
+				DecompressPoseAndCurves(Requests[SortedRequests[EntryIndex].RequestIndex]);
+			}
+		});
+}
@@ -0,0 +1,337 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLBulkDecompression.h"
+
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "Async/ParallelFor.h"
+
+#include "AnimBoneCompressionCodec_ACL.h"
+#include "AnimBoneCompressionCodec_ACLSafe.h"
+#include "ACLDecompressionImpl.h"
+
+/*
+ * Output track writer for a whole frame in a structure of arrays.
+ */
+struct FACLSoAOutputWriter final : public acl::track_writer
+{
+	// Raw pointers for performance reasons, they point to the current frame
+	FQuat* Rotations;
+	FVector* Translations;
+	FVector* Scales;
+
+	FACLSoAOutputWriter(FQuat* Rotations_, FVector* Translations_, FVector* Scales_)
+		: Rotations(Rotations_)
+		, Translations(Translations_)
+		, Scales(Scales_)
+	{}
+
+	bool skip_track_scale(uint32_t TrackIndex) const { return Scales == nullptr; }
+
+	void RTM_SIMD_CALL write_rotation(uint32_t TrackIndex, rtm::quatf_arg0 Rotation)
+	{
+		rtm::quat_store(Rotation, &Rotations[TrackIndex].X);
+	}
+
+	void RTM_SIMD_CALL write_translation(uint32_t TrackIndex, rtm::vector4f_arg0 Translation)
+	{
+		rtm::vector_store3(Translation, &Translations[TrackIndex].X);
+	}
+
+	void RTM_SIMD_CALL write_scale(uint32_t TrackIndex, rtm::vector4f_arg0 Scale)
+	{
+		rtm::vector_store3(Scale, &Scales[TrackIndex].X);
+	}
+};
+
+/*
+ * Output track writer for a subset of the tracks, every other track is skipped.
+ */
+struct FACLSubsetOutputWriter final : public acl::track_writer
+{
+	// Raw pointers for performance reasons, caller is responsible for ensuring data is valid
+	FACLTransform* Transforms;
+	const int32* TrackToTransformMap;
+
+	FACLSubsetOutputWriter(FTransform* Transforms_, const int32* TrackToTransformMap_)
+		: Transforms(static_cast<FACLTransform*>(Transforms_))
+		, TrackToTransformMap(TrackToTransformMap_)
+	{}
+
+	bool skip_track_rotation(uint32_t TrackIndex) const { return TrackToTransformMap[TrackIndex] < 0; }
+	bool skip_track_translation(uint32_t TrackIndex) const { return TrackToTransformMap[TrackIndex] < 0; }
+	bool skip_track_scale(uint32_t TrackIndex) const { return TrackToTransformMap[TrackIndex] < 0; }
+
+	void RTM_SIMD_CALL write_rotation(uint32_t TrackIndex, rtm::quatf_arg0 Rotation)
+	{
+		Transforms[TrackToTransformMap[TrackIndex]].SetRotationRaw(Rotation);
+	}
+
+	void RTM_SIMD_CALL write_translation(uint32_t TrackIndex, rtm::vector4f_arg0 Translation)
+	{
+		Transforms[TrackToTransformMap[TrackIndex]].SetTranslationRaw(Translation);
+	}
+
+	void RTM_SIMD_CALL write_scale(uint32_t TrackIndex, rtm::vector4f_arg0 Scale)
+	{
+		Transforms[TrackToTransformMap[TrackIndex]].SetScale3DRaw(Scale);
+	}
+};
+
+/** Returns the ACL compressed data of the anim sequence or nullptr if it isn't compressed with ACL. */
+static const acl::compressed_tracks* GetCompressedTracks(const UAnimSequence& AnimSeq)
+{
+	const UAnimBoneCompressionCodec* Codec = AnimSeq.CompressedData.BoneCompressionCodec;
+	if (Codec == nullptr || !Codec->IsA<UAnimBoneCompressionCodec_ACLBase>() || !AnimSeq.CompressedData.CompressedDataStructure.IsValid())
+	{
+		return nullptr;
+	}
+
+	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(*AnimSeq.CompressedData.CompressedDataStructure);
+	return AnimData.IsValid() ? acl::make_compressed_tracks(AnimData.CompressedByteStream.GetData()) : nullptr;
+}
+
+/** Calls the provided function with the decompression settings that match the codec of the anim sequence. */
+template<typename FunctionType>
+static void DispatchDecompressionSettings(const UAnimSequence& AnimSeq, FunctionType&& Function)
+{
+	const UAnimBoneCompressionCodec* Codec = AnimSeq.CompressedData.BoneCompressionCodec;
+	if (Codec->IsA<UAnimBoneCompressionCodec_ACL>())
+	{
+		Function(UE4DefaultDecompressionSettings());
+	}
+	else if (Codec->IsA<UAnimBoneCompressionCodec_ACLSafe>())
+	{
+		Function(UE4SafeDecompressionSettings());
+	}
+	else
+	{
+		Function(UE4CustomDecompressionSettings());
+	}
+}
+
+/*
+ * Splits the frame range into the segments it overlaps and calls the provided function for each of them,
+ * possibly in parallel. When segments aren't decompressed in parallel, the function is called once for the whole range.
+ */
+template<typename FunctionType>
+static void ForEachSegmentFrameRange(const acl::compressed_tracks& CompressedClipData, int32 FirstFrame, int32 LastFrame, bool bParallel, FunctionType&& Function)
+{
+	const acl::acl_impl::transform_tracks_header& TransformHeader = acl::acl_impl::get_transform_tracks_header(CompressedClipData);
+	if (!bParallel || TransformHeader.num_segments <= 1 || !TransformHeader.segment_start_indices_offset.is_valid())
+	{
+		Function(FirstFrame, LastFrame);
+		return;
+	}
+
+	const uint32* SegmentStartIndices = TransformHeader.get_segment_start_indices();
+	const int32 NumSegments = int32(TransformHeader.num_segments);
+	const int32 NumSamples = int32(CompressedClipData.get_num_samples_per_track());
+
+	ParallelFor(NumSegments, [&](int32 SegmentIndex)
+		{
+			const int32 SegmentFirstFrame = int32(SegmentStartIndices[SegmentIndex]);
+			const int32 SegmentLastFrame = SegmentIndex + 1 < NumSegments ? int32(SegmentStartIndices[SegmentIndex + 1]) - 1 : NumSamples - 1;
+
+			const int32 RangeFirstFrame = FMath::Max(SegmentFirstFrame, FirstFrame);
+			const int32 RangeLastFrame = FMath::Min(SegmentLastFrame, LastFrame);
+			if (RangeFirstFrame <= RangeLastFrame)
+			{
+				Function(RangeFirstFrame, RangeLastFrame);
+			}
+		});
+}
+
+/** Seeks to every frame of the range in order and calls the provided function to decompress it. */
+template<typename DecompressionSettingsType, typename FunctionType>
+static void ForEachFrame(const acl::compressed_tracks& CompressedClipData, int32 FirstFrame, int32 LastFrame, FunctionType&& Function)
+{
+	acl::decompression_context<DecompressionSettingsType> Context;
+	Context.initialize(CompressedClipData);
+
+	const float SampleRate = CompressedClipData.get_sample_rate();
+
+	for (int32 FrameIndex = FirstFrame; FrameIndex <= LastFrame; ++FrameIndex)
+	{
+		// Consecutive frames are in the same segment most of the time, seeking is then cheap
+		Context.seek(float(FrameIndex) / SampleRate, acl::sample_rounding_policy::nearest);
+		Function(Context, FrameIndex);
+	}
+}
+
+/** Sets up the output clip for the requested frame range and returns the index of the last frame. */
+static int32 InitDecompressedClip(const acl::compressed_tracks& CompressedClipData, int32 NumTracks, int32 FirstFrame, int32 NumFrames, FACLDecompressedClip& OutClip)
+{
+	const int32 NumSamples = int32(CompressedClipData.get_num_samples_per_track());
+	FirstFrame = FMath::Clamp(FirstFrame, 0, NumSamples);
+	NumFrames = NumFrames == INDEX_NONE ? (NumSamples - FirstFrame) : FMath::Clamp(NumFrames, 0, NumSamples - FirstFrame);
+
+	OutClip.NumTracks = NumTracks;
+	OutClip.FirstFrame = FirstFrame;
+	OutClip.NumFrames = NumFrames;
+	OutClip.SampleRate = CompressedClipData.get_sample_rate();
+
+	const int32 NumValues = NumTracks * NumFrames;
+	OutClip.Rotations.SetNumUninitialized(NumValues);
+	OutClip.Translations.SetNumUninitialized(NumValues);
+	if (acl::acl_impl::get_tracks_header(CompressedClipData).get_has_scale())
+	{
+		OutClip.Scales.SetNumUninitialized(NumValues);
+	}
+
+	return FirstFrame + NumFrames - 1;
+}
+
+bool DecompressClip(const UAnimSequence& AnimSeq, FACLDecompressedClip& OutClip, int32 FirstFrame, int32 NumFrames, bool bParallel)
+{
+	OutClip = FACLDecompressedClip();
+
+	const acl::compressed_tracks* CompressedClipData = GetCompressedTracks(AnimSeq);
+	if (CompressedClipData == nullptr)
+	{
+		return false;
+	}
+
+	const int32 LastFrame = InitDecompressedClip(*CompressedClipData, int32(CompressedClipData->get_num_tracks()), FirstFrame, NumFrames, OutClip);
+	const bool bHasScale = OutClip.HasScale();
+
+	DispatchDecompressionSettings(AnimSeq, [&](auto Settings)
+		{
+			using DecompressionSettingsType = decltype(Settings);
+
+			ForEachSegmentFrameRange(*CompressedClipData, OutClip.FirstFrame, LastFrame, bParallel, [&](int32 RangeFirstFrame, int32 RangeLastFrame)
+				{
+					ForEachFrame<DecompressionSettingsType>(*CompressedClipData, RangeFirstFrame, RangeLastFrame, [&](auto& Context, int32 FrameIndex)
+						{
+							const int32 Offset = OutClip.GetIndex(FrameIndex, 0);
+							FACLSoAOutputWriter Writer(OutClip.Rotations.GetData() + Offset, OutClip.Translations.GetData() + Offset, bHasScale ? OutClip.Scales.GetData() + Offset : nullptr);
+							Context.decompress_tracks(Writer);
+						});
+				});
+		});
+
+	return true;
+}
+
+bool DecompressClipBones(const UAnimSequence& AnimSeq, TArrayView<const int32> BoneIndices, FACLDecompressedClip& OutClip, int32 FirstFrame, int32 NumFrames, bool bComponentSpace, bool bParallel)
+{
+	OutClip = FACLDecompressedClip();
+
+	const acl::compressed_tracks* CompressedClipData = GetCompressedTracks(AnimSeq);
+	const USkeleton* Skeleton = AnimSeq.GetSkeleton();
+	if (CompressedClipData == nullptr || Skeleton == nullptr)
+	{
+		return false;
+	}
+
+	const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+	const TArray<FTransform>& RefSkeletonPose = RefSkeleton.GetRefBonePose();
+	const int32 NumSkeletonBones = RefSkeleton.GetNum();
+
+	for (int32 BoneIndex : BoneIndices)
+	{
+		if (BoneIndex < 0 || BoneIndex >= NumSkeletonBones)
+		{
+			return false;
+		}
+	}
+
+	// Component space requires every parent of the requested bones as well
+	TBitArray<> RequiredBones(false, NumSkeletonBones);
+	for (int32 BoneIndex : BoneIndices)
+	{
+		for (int32 ParentIndex = BoneIndex; ParentIndex != INDEX_NONE && !RequiredBones[ParentIndex]; ParentIndex = bComponentSpace ? RefSkeleton.GetParentIndex(ParentIndex) : INDEX_NONE)
+		{
+			RequiredBones[ParentIndex] = true;
+		}
+	}
+
+	// Parents always have a lower index than their children in the reference skeleton
+	TArray<int32> BoneToTransformMap;
+	BoneToTransformMap.Init(INDEX_NONE, NumSkeletonBones);
+
+	TArray<int32> TransformParents;
+	TArray<FTransform> DefaultTransforms;
+
+	const bool bIsAdditive = AnimSeq.IsValidAdditive();
+	for (TConstSetBitIterator<> It(RequiredBones); It; ++It)
+	{
+		const int32 BoneIndex = It.GetIndex();
+		const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+
+		BoneToTransformMap[BoneIndex] = DefaultTransforms.Num();
+		TransformParents.Add(bComponentSpace && ParentIndex != INDEX_NONE ? BoneToTransformMap[ParentIndex] : INDEX_NONE);
+
+		// Bones without a track keep their reference pose, or the identity when additive
+		DefaultTransforms.Add(bIsAdditive ? FTransform::Identity : RefSkeletonPose[BoneIndex]);
+	}
+
+	const int32 NumACLTracks = int32(CompressedClipData->get_num_tracks());
+	TArray<int32> TrackToTransformMap;
+	TrackToTransformMap.Init(INDEX_NONE, NumACLTracks);
+
+	const TArray<FTrackToSkeletonMap>& TrackToSkeletonMap = AnimSeq.CompressedData.CompressedTrackToSkeletonMapTable;
+	for (int32 TrackIndex = 0; TrackIndex < FMath::Min(TrackToSkeletonMap.Num(), NumACLTracks); ++TrackIndex)
+	{
+		const int32 BoneIndex = TrackToSkeletonMap[TrackIndex].BoneTreeIndex;
+		if (BoneIndex >= 0 && BoneIndex < NumSkeletonBones)
+		{
+			TrackToTransformMap[TrackIndex] = BoneToTransformMap[BoneIndex];
+		}
+	}
+
+	const int32 LastFrame = InitDecompressedClip(*CompressedClipData, BoneIndices.Num(), FirstFrame, NumFrames, OutClip);
+	const bool bHasScale = OutClip.HasScale();
+	const int32 NumTransforms = DefaultTransforms.Num();
+
+	DispatchDecompressionSettings(AnimSeq, [&](auto Settings)
+		{
+			using DecompressionSettingsType = decltype(Settings);
+
+			ForEachSegmentFrameRange(*CompressedClipData, OutClip.FirstFrame, LastFrame, bParallel, [&](int32 RangeFirstFrame, int32 RangeLastFrame)
+				{
+					// Every range has its own scratch pose since they can run in parallel
+					TArray<FTransform> Transforms = DefaultTransforms;
+					FACLSubsetOutputWriter Writer(Transforms.GetData(), TrackToTransformMap.GetData());
+
+					ForEachFrame<DecompressionSettingsType>(*CompressedClipData, RangeFirstFrame, RangeLastFrame, [&](auto& Context, int32 FrameIndex)
+						{
+							Context.decompress_tracks(Writer);
+
+							if (bComponentSpace)
+							{
+								for (int32 TransformIndex = 0; TransformIndex < NumTransforms; ++TransformIndex)
+								{
+									const int32 ParentIndex = TransformParents[TransformIndex];
+									if (ParentIndex != INDEX_NONE)
+									{
+										Transforms[TransformIndex] = Transforms[TransformIndex] * Transforms[ParentIndex];
+									}
+								}
+							}
+
+							for (int32 OutputIndex = 0; OutputIndex < BoneIndices.Num(); ++OutputIndex)
+							{
+								const FTransform& Transform = Transforms[BoneToTransformMap[BoneIndices[OutputIndex]]];
+								const int32 Index = OutClip.GetIndex(FrameIndex, OutputIndex);
+
+								OutClip.Rotations[Index] = Transform.GetRotation();
+								OutClip.Translations[Index] = Transform.GetTranslation();
+								if (bHasScale)
+								{
+									OutClip.Scales[Index] = Transform.GetScale3D();
+								}
+							}
+
+							if (bComponentSpace)
+							{
+								// Bones without a track aren't written by the decoder, restore their local transform
+								// The writer points into the scratch pose, it must not be reallocated
+								FMemory::Memcpy(Transforms.GetData(), DefaultTransforms.GetData(), NumTransforms * sizeof(FTransform));
+							}
+						});
+				});
+		});
+
+	return true;
+}
@@ -3,12 +3,79 @@
 // Copyright 2018 Nicholas Frechette. All Rights Reserved.
 
 #include "CoreMinimal.h"
+#include "Animation/AnimCurveTypes.h"
+#include "AnimBoneCompressionCodec_ACLBase.h"
+#include "ACLDecompressionQuality.h"
 #include "ACLImpl.h"
+#include "ACLPoseCache.h"
 
 #include <acl/decompression/decompress.h>
 
+#if WITH_ACL_TELEMETRY
+/*
+ * Records a decompression call in the telemetry of the anim sequence when it is enabled.
+ * The number of bytes touched is an upper bound: the size of the compressed data we read from.
+ */
+struct FACLTelemetryScope
+{
+	FACLDecompressionTelemetry* Telemetry;
+	uint64 StartTimeCycles;
+	int64 NumBytesTouched;
+	bool bIsNewCall;
+
+	FACLTelemetryScope(const FACLCompressedAnimData& AnimData, int64 NumBytesTouched_, bool bIsNewCall_)
+		: Telemetry(GACLEnableTelemetry != 0 ? &AnimData.Telemetry : nullptr)
+		, StartTimeCycles(Telemetry != nullptr ? FPlatformTime::Cycles64() : 0)
+		, NumBytesTouched(NumBytesTouched_)
+		, bIsNewCall(bIsNewCall_)
+	{}
+
+	~FACLTelemetryScope()
+	{
+		if (Telemetry != nullptr)
+		{
+			if (bIsNewCall)
+			{
+				Telemetry->NumDecompressionCalls.Increment();
+			}
+
+			Telemetry->DecompressionCycles.Add(FPlatformTime::Cycles64() - StartTimeCycles);
+			Telemetry->NumBytesTouched.Add(NumBytesTouched);
+			Telemetry->LastUsedFrame.Set(GFrameCounter);
+		}
+	}
+};
+
+#define ACL_TELEMETRY_SCOPE(AnimData, NumBytesTouched, bIsNewCall) FACLTelemetryScope ACLTelemetryScope(AnimData, NumBytesTouched, bIsNewCall)
+#else
+#define ACL_TELEMETRY_SCOPE(AnimData, NumBytesTouched, bIsNewCall)
+#endif
+
 constexpr acl::sample_rounding_policy get_rounding_policy(EAnimInterpolationType InterpType) { return InterpType == EAnimInterpolationType::Step ? acl::sample_rounding_policy::floor : acl::sample_rounding_policy::none; }
 
+/** Adjusts the sample time and returns the rounding policy to seek with based on the decompression quality of the calling thread. */
+FORCEINLINE acl::sample_rounding_policy GetQualitySeekParameters(const acl::compressed_tracks& CompressedClipData, EAnimInterpolationType InterpType, float& InOutSampleTime)
+{
+	const EACLDecompressionQuality Quality = FACLScopedDecompressionQuality::GetCurrent();
+	if (Quality == EACLDecompressionQuality::Full || InterpType == EAnimInterpolationType::Step)
+	{
+		return get_rounding_policy(InterpType);
+	}
+
+	if (Quality == EACLDecompressionQuality::HalfRate)
+	{
+		// Snap to an even sample, the nearest rounding below absorbs any floating point error
+		const float SampleRate = CompressedClipData.get_sample_rate();
+		if (SampleRate > 0.0f)
+		{
+			const float HalfSampleRate = SampleRate * 0.5f;
+			InOutSampleTime = FMath::FloorToFloat(InOutSampleTime * HalfSampleRate) / HalfSampleRate;
+		}
+	}
+
+	return acl::sample_rounding_policy::nearest;
+}
+
 /*
  * The FTransform type does not support setting the members directly from vector types
  * so we derive from it and expose that functionality.
@@ -139,37 +206,160 @@ struct UE4OutputTrackWriter final : public acl::track_writer
 using UE4DefaultDecompressionSettings = acl::default_transform_decompression_settings;
 using UE4CustomDecompressionSettings = acl::debug_transform_decompression_settings;
 
+#ifndef ACL_WITH_FORMAT_MANIFEST
+	#define ACL_WITH_FORMAT_MANIFEST 0
+#endif
+
+#ifndef ACL_MANIFEST_ROTATION_QUATF_FULL
+	#define ACL_MANIFEST_ROTATION_QUATF_FULL 0
+#endif
+#ifndef ACL_MANIFEST_ROTATION_QUATF_DROP_W_FULL
+	#define ACL_MANIFEST_ROTATION_QUATF_DROP_W_FULL 0
+#endif
+#ifndef ACL_MANIFEST_ROTATION_QUATF_DROP_W_VARIABLE
+	#define ACL_MANIFEST_ROTATION_QUATF_DROP_W_VARIABLE 0
+#endif
+#ifndef ACL_MANIFEST_TRANSLATION_VECTOR3F_FULL
+	#define ACL_MANIFEST_TRANSLATION_VECTOR3F_FULL 0
+#endif
+#ifndef ACL_MANIFEST_TRANSLATION_VECTOR3F_VARIABLE
+	#define ACL_MANIFEST_TRANSLATION_VECTOR3F_VARIABLE 0
+#endif
+#ifndef ACL_MANIFEST_SCALE_VECTOR3F_FULL
+	#define ACL_MANIFEST_SCALE_VECTOR3F_FULL 0
+#endif
+#ifndef ACL_MANIFEST_SCALE_VECTOR3F_VARIABLE
+	#define ACL_MANIFEST_SCALE_VECTOR3F_VARIABLE 0
+#endif
+
+/*
+ * Only supports the formats listed in the cooked format manifest, see ACLFormatManifest.h
+ * When a single format is used, it is returned as a constant and the decoder strips every other code path.
+ */
+struct UE4ManifestDecompressionSettings final : public UE4CustomDecompressionSettings
+{
+	static constexpr bool is_rotation_format_supported(acl::rotation_format8 format)
+	{
+		return (ACL_MANIFEST_ROTATION_QUATF_FULL && format == acl::rotation_format8::quatf_full)
+			|| (ACL_MANIFEST_ROTATION_QUATF_DROP_W_FULL && format == acl::rotation_format8::quatf_drop_w_full)
+			|| (ACL_MANIFEST_ROTATION_QUATF_DROP_W_VARIABLE && format == acl::rotation_format8::quatf_drop_w_variable);
+	}
+
+	static constexpr acl::rotation_format8 get_rotation_format(acl::rotation_format8 format)
+	{
+		return (ACL_MANIFEST_ROTATION_QUATF_FULL + ACL_MANIFEST_ROTATION_QUATF_DROP_W_FULL + ACL_MANIFEST_ROTATION_QUATF_DROP_W_VARIABLE) != 1 ? format
+			: ACL_MANIFEST_ROTATION_QUATF_FULL ? acl::rotation_format8::quatf_full
+			: ACL_MANIFEST_ROTATION_QUATF_DROP_W_FULL ? acl::rotation_format8::quatf_drop_w_full
+			: acl::rotation_format8::quatf_drop_w_variable;
+	}
+
+	static constexpr bool is_translation_format_supported(acl::vector_format8 format)
+	{
+		return (ACL_MANIFEST_TRANSLATION_VECTOR3F_FULL && format == acl::vector_format8::vector3f_full)
+			|| (ACL_MANIFEST_TRANSLATION_VECTOR3F_VARIABLE && format == acl::vector_format8::vector3f_variable);
+	}
+
+	static constexpr acl::vector_format8 get_translation_format(acl::vector_format8 format)
+	{
+		return (ACL_MANIFEST_TRANSLATION_VECTOR3F_FULL + ACL_MANIFEST_TRANSLATION_VECTOR3F_VARIABLE) != 1 ? format
+			: ACL_MANIFEST_TRANSLATION_VECTOR3F_FULL ? acl::vector_format8::vector3f_full
+			: acl::vector_format8::vector3f_variable;
+	}
+
+	static constexpr bool is_scale_format_supported(acl::vector_format8 format)
+	{
+		return (ACL_MANIFEST_SCALE_VECTOR3F_FULL && format == acl::vector_format8::vector3f_full)
+			|| (ACL_MANIFEST_SCALE_VECTOR3F_VARIABLE && format == acl::vector_format8::vector3f_variable);
+	}
+
+	static constexpr acl::vector_format8 get_scale_format(acl::vector_format8 format)
+	{
+		return (ACL_MANIFEST_SCALE_VECTOR3F_FULL + ACL_MANIFEST_SCALE_VECTOR3F_VARIABLE) != 1 ? format
+			: ACL_MANIFEST_SCALE_VECTOR3F_FULL ? acl::vector_format8::vector3f_full
+			: acl::vector_format8::vector3f_variable;
+	}
+};
+
+/** Whether the compressed data only uses formats from the format manifest, data cooked before the manifest was generated might not. */
+FORCEINLINE bool IsSupportedByFormatManifest(const acl::compressed_tracks& CompressedClipData)
+{
+#if ACL_WITH_FORMAT_MANIFEST
+	const acl::acl_impl::tracks_header& TracksHeader = acl::acl_impl::get_tracks_header(CompressedClipData);
+
+	return UE4ManifestDecompressionSettings::is_rotation_format_supported(TracksHeader.get_rotation_format())
+		&& UE4ManifestDecompressionSettings::is_translation_format_supported(TracksHeader.get_translation_format())
+		&& (!TracksHeader.get_has_scale() || UE4ManifestDecompressionSettings::is_scale_format_supported(TracksHeader.get_scale_format()));
+#else
+	return false;
+#endif
+}
+
 struct UE4SafeDecompressionSettings final : public UE4DefaultDecompressionSettings
 {
 	static constexpr bool is_rotation_format_supported(acl::rotation_format8 format) { return format == acl::rotation_format8::quatf_full; }
 	static constexpr acl::rotation_format8 get_rotation_format(acl::rotation_format8 /*format*/) { return acl::rotation_format8::quatf_full; }
 };
 
+struct UE4CurveDecompressionSettings final : public acl::decompression_settings
+{
+	static constexpr bool is_track_type_supported(acl::track_type8 type) { return type == acl::track_type8::float1f; }
+};
+
+struct UE4CurveWriter final : public acl::track_writer
+{
+	const TArray<FSmartName>& CompressedCurveNames;
+	FBlendedCurve& Curves;
+
+	UE4CurveWriter(const TArray<FSmartName>& CompressedCurveNames_, FBlendedCurve& Curves_)
+		: CompressedCurveNames(CompressedCurveNames_)
+		, Curves(Curves_)
+	{
+	}
+
+	void write_float1(uint32_t TrackIndex, rtm::scalarf_arg0 Value)
+	{
+		const FSmartName& CurveName = CompressedCurveNames[TrackIndex];
+		if (Curves.IsEnabled(CurveName.UID))
+		{
+			Curves.Set(CurveName.UID, rtm::scalar_cast(Value));
+		}
+	}
+};
+
 template<typename DecompressionSettingsType>
 FORCEINLINE_DEBUGGABLE void DecompressBone(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom)
 {
 	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData);
 	const acl::compressed_tracks* CompressedClipData = acl::make_compressed_tracks(AnimData.CompressedByteStream.GetData());
-	check(CompressedClipData != nullptr && CompressedClipData->is_valid(false).empty());
+	checkSlow(CompressedClipData != nullptr && AnimData.IsValid());
+
+	ACL_TELEMETRY_SCOPE(AnimData, AnimData.CompressedByteStream.Num(), true);
+
+	float SampleTime = DecompContext.Time;
+	const acl::sample_rounding_policy RoundingPolicy = GetQualitySeekParameters(*CompressedClipData, DecompContext.Interpolation, SampleTime);
 
 	acl::decompression_context<DecompressionSettingsType> Context;
 	Context.initialize(*CompressedClipData);
-	Context.seek(DecompContext.Time, get_rounding_policy(DecompContext.Interpolation));
+	Context.seek(SampleTime, RoundingPolicy);
 
 	UE4OutputTrackWriter Writer(OutAtom);
 	Context.decompress_track(TrackIndex, Writer);
 }
 
 template<typename DecompressionSettingsType>
-FORCEINLINE_DEBUGGABLE void DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+FORCEINLINE_DEBUGGABLE void DecompressPoseAtTime(const FAnimSequenceDecompressionContext& DecompContext, float SampleTime, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
 {
 	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData);
 	const acl::compressed_tracks* CompressedClipData = acl::make_compressed_tracks(AnimData.CompressedByteStream.GetData());
-	check(CompressedClipData != nullptr && CompressedClipData->is_valid(false).empty());
+	checkSlow(CompressedClipData != nullptr && AnimData.IsValid());
+
+	ACL_TELEMETRY_SCOPE(AnimData, AnimData.CompressedByteStream.Num(), true);
+
+	const acl::sample_rounding_policy RoundingPolicy = GetQualitySeekParameters(*CompressedClipData, DecompContext.Interpolation, SampleTime);
 
 	acl::decompression_context<DecompressionSettingsType> Context;
 	Context.initialize(*CompressedClipData);
-	Context.seek(DecompContext.Time, get_rounding_policy(DecompContext.Interpolation));
+	Context.seek(SampleTime, RoundingPolicy);
 
 	const int32 ACLBoneCount = CompressedClipData->get_num_tracks();
 
@@ -248,3 +438,37 @@ FORCEINLINE_DEBUGGABLE void DecompressPose(FAnimSequenceDecompressionContext& De
 	FUE4OutputWriter PoseWriter(OutAtoms, TrackToAtomsMap);
 	Context.decompress_tracks(PoseWriter);
 }
+
+template<typename DecompressionSettingsType>
+FORCENOINLINE void DecompressPoseWithCache(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+{
+	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData);
+	FACLPoseCache& PoseCache = FACLPoseCache::Get();
+
+	float SampleTime;
+	const FACLPoseCacheKey Key = FACLPoseCache::MakeKey(AnimData, DecompContext, RotationPairs, TranslationPairs, ScalePairs, SampleTime);
+	if (PoseCache.Find(Key, RotationPairs, TranslationPairs, ScalePairs, OutAtoms))
+	{
+		return;
+	}
+
+	// Decompress at the quantized time so that every instance sharing the key sees the same pose
+	DecompressPoseAtTime<DecompressionSettingsType>(DecompContext, SampleTime, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+
+	const acl::compressed_tracks* CompressedClipData = acl::make_compressed_tracks(AnimData.CompressedByteStream.GetData());
+	const bool bHasScale = acl::acl_impl::get_tracks_header(*CompressedClipData).get_has_scale();
+	PoseCache.Add(Key, RotationPairs, TranslationPairs, ScalePairs, OutAtoms, bHasScale);
+}
+
+template<typename DecompressionSettingsType>
+FORCEINLINE_DEBUGGABLE void DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+{
+	if (GACLPoseCacheEnabled != 0)
+	{
+		DecompressPoseWithCache<DecompressionSettingsType>(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+	}
+	else
+	{
+		DecompressPoseAtTime<DecompressionSettingsType>(DecompContext, DecompContext.Time, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+	}
+}
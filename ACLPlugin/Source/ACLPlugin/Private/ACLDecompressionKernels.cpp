@@ -0,0 +1,102 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLDecompressionKernels.h"
+
+#include "AnimationCompression.h"
+
+#include "ACLDecompressionImpl.h"
+
+template<typename DecompressionSettingsType>
+static void DecompressPose_Baseline(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+{
+	::DecompressPose<DecompressionSettingsType>(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+}
+
+template<typename DecompressionSettingsType>
+static void DecompressBone_Baseline(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom)
+{
+	::DecompressBone<DecompressionSettingsType>(DecompContext, TrackIndex, OutAtom);
+}
+
+static const FACLDecompressionKernels BaselineKernels =
+{
+	{ &DecompressPose_Baseline<UE4DefaultDecompressionSettings>, &DecompressBone_Baseline<UE4DefaultDecompressionSettings> },
+	{ &DecompressPose_Baseline<UE4SafeDecompressionSettings>, &DecompressBone_Baseline<UE4SafeDecompressionSettings> },
+	{ &DecompressPose_Baseline<UE4CustomDecompressionSettings>, &DecompressBone_Baseline<UE4CustomDecompressionSettings> },
+	{ &DecompressPose_Baseline<UE4ManifestDecompressionSettings>, &DecompressBone_Baseline<UE4ManifestDecompressionSettings> },
+};
+
+// Usable before the module starts up, e.g. when sequences are decompressed while loading
+FACLDecompressionKernels GACLDecompressionKernels = BaselineKernels;
+static EACLDecompressionISA GActiveDecompressionISA = EACLDecompressionISA::Baseline;
+
+#if WITH_ACL_ISA_DISPATCH
+static bool IsISASupported(EACLDecompressionISA ISA)
+{
+	__builtin_cpu_init();
+
+	switch (ISA)
+	{
+	case EACLDecompressionISA::Baseline:	return true;
+	case EACLDecompressionISA::SSE41:		return __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("popcnt");
+	case EACLDecompressionISA::AVX2:		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("popcnt");
+	default:								return false;
+	}
+}
+#endif
+
+const FACLDecompressionKernels* GetACLDecompressionKernels(EACLDecompressionISA ISA)
+{
+#if WITH_ACL_ISA_DISPATCH
+	if (!IsISASupported(ISA))
+	{
+		return nullptr;
+	}
+
+	static const FACLDecompressionKernels SSE41Kernels = GetACLDecompressionKernels_SSE41();
+	static const FACLDecompressionKernels AVX2Kernels = GetACLDecompressionKernels_AVX2();
+
+	switch (ISA)
+	{
+	case EACLDecompressionISA::SSE41:	return &SSE41Kernels;
+	case EACLDecompressionISA::AVX2:	return &AVX2Kernels;
+	default:							break;
+	}
+#endif
+
+	return ISA == EACLDecompressionISA::Baseline ? &BaselineKernels : nullptr;
+}
+
+void InitACLDecompressionKernels()
+{
+	// Pick the most recent instruction set first
+	for (int32 ISAIndex = int32(EACLDecompressionISA::Count) - 1; ISAIndex >= 0; --ISAIndex)
+	{
+		const EACLDecompressionISA ISA = EACLDecompressionISA(ISAIndex);
+		const FACLDecompressionKernels* Kernels = GetACLDecompressionKernels(ISA);
+		if (Kernels != nullptr)
+		{
+			GACLDecompressionKernels = *Kernels;
+			GActiveDecompressionISA = ISA;
+			break;
+		}
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("ACL decompression uses the %s instruction set"), GetACLDecompressionISAName(GActiveDecompressionISA));
+}
+
+EACLDecompressionISA GetActiveACLDecompressionISA()
+{
+	return GActiveDecompressionISA;
+}
+
+const TCHAR* GetACLDecompressionISAName(EACLDecompressionISA ISA)
+{
+	switch (ISA)
+	{
+	case EACLDecompressionISA::Baseline:	return TEXT("Baseline");
+	case EACLDecompressionISA::SSE41:		return TEXT("SSE4.1");
+	case EACLDecompressionISA::AVX2:		return TEXT("AVX2");
+	default:								return TEXT("<Unknown>");
+	}
+}
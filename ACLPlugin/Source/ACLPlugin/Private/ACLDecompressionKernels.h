@@ -0,0 +1,76 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "AnimEncoding.h"
+
+/*
+ * The decoders of the ACL codecs are also built for newer instruction sets and the best one supported by the CPU
+ * is selected when the module starts up. This requires clang function target attributes and is only
+ * enabled for x64 Linux game and server builds, everything else uses the baseline decoders.
+ * The editor is excluded because it includes the ACL headers for compression before the decoders are built.
+ */
+#if PLATFORM_LINUX && PLATFORM_CPU_X86_FAMILY && PLATFORM_64BITS && defined(__clang__) && !WITH_EDITORONLY_DATA
+	#define WITH_ACL_ISA_DISPATCH 1
+#else
+	#define WITH_ACL_ISA_DISPATCH 0
+#endif
+
+enum class EACLDecompressionISA : uint8
+{
+	/** The instruction set the plugin is compiled with, SSE2 on x64. */
+	Baseline,
+
+	/** SSE4.1 with POPCNT. */
+	SSE41,
+
+	/** AVX2 with FMA and POPCNT. */
+	AVX2,
+
+	Count,
+};
+
+/** The pose and bone decoders built for one set of ACL decompression settings. */
+struct FACLDecoderKernels
+{
+	using DecompressPoseFuncPtr = void(*)(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms);
+	using DecompressBoneFuncPtr = void(*)(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom);
+
+	DecompressPoseFuncPtr DecompressPose;
+	DecompressBoneFuncPtr DecompressBone;
+};
+
+/** The decoders of the ACL codecs built for a specific instruction set. */
+struct FACLDecompressionKernels
+{
+	/** Used by the ACL codec. */
+	FACLDecoderKernels Default;
+
+	/** Used by the ACLSafe codec. */
+	FACLDecoderKernels Safe;
+
+	/** Used by the ACLCustom codec, the manifest decoder only supports the formats of the format manifest. */
+	FACLDecoderKernels Custom;
+	FACLDecoderKernels Manifest;
+};
+
+/** The decoders used by the ACL codecs, selected by InitACLDecompressionKernels. */
+extern FACLDecompressionKernels GACLDecompressionKernels;
+
+/** Selects the decoders for the best instruction set supported by the CPU. */
+void InitACLDecompressionKernels();
+
+/** Returns the decoders for the provided instruction set or nullptr if the CPU or the build doesn't support it. */
+const FACLDecompressionKernels* GetACLDecompressionKernels(EACLDecompressionISA ISA);
+
+/** Returns the instruction set of the decoders currently used. */
+EACLDecompressionISA GetActiveACLDecompressionISA();
+
+const TCHAR* GetACLDecompressionISAName(EACLDecompressionISA ISA);
+
+#if WITH_ACL_ISA_DISPATCH
+// Implemented by the translation units built for each instruction set
+FACLDecompressionKernels GetACLDecompressionKernels_SSE41();
+FACLDecompressionKernels GetACLDecompressionKernels_AVX2();
+#endif
@@ -0,0 +1,100 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+/*
+ * Builds the ACL codec decoders for a specific instruction set.
+ *
+ * The including translation unit defines ACL_KERNEL_SUFFIX, ACL_KERNEL_TARGET (the clang target attribute),
+ * and the RTM/ACL intrinsic macros for that instruction set. This file must be included before anything
+ * that includes the ACL or RTM headers.
+ *
+ * ACL and RTM are header only and their functions would have the same symbols in every translation unit.
+ * The linker could then keep a version built for an instruction set the CPU doesn't support. To avoid this,
+ * the ACL and RTM namespaces along with our own decoder symbols are renamed with the kernel suffix.
+ *
+ * The renaming relies on the headers listed below being included before the target attribute applies.
+ * As a safety net, everything built with the target attribute lives in an anonymous namespace and has
+ * internal linkage: a header missing from the list either fails to compile inside the namespace or
+ * its functions can't be merged by the linker with the baseline versions.
+ */
+
+#include "ACLDecompressionKernels.h"
+
+#if WITH_ACL_ISA_DISPATCH
+// Standard and engine headers must be included with their usual names and targets
+#include <immintrin.h>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <memory>
+
+#include "Animation/AnimCurveTypes.h"
+#include "AnimBoneCompressionCodec_ACLBase.h"
+#include "ACLDecompressionQuality.h"
+#include "ACLPoseCache.h"
+
+#define ACL_KERNEL_CONCAT_IMPL(A, B) A##B
+#define ACL_KERNEL_CONCAT(A, B) ACL_KERNEL_CONCAT_IMPL(A, B)
+#define ACL_KERNEL_NAME(Name) ACL_KERNEL_CONCAT(Name##_, ACL_KERNEL_SUFFIX)
+
+#define acl ACL_KERNEL_NAME(acl)
+#define rtm ACL_KERNEL_NAME(rtm)
+#define ACLAllocator ACL_KERNEL_NAME(ACLAllocator)
+#define VectorCast ACL_KERNEL_NAME(VectorCast)
+#define QuatCast ACL_KERNEL_NAME(QuatCast)
+#define TransformCast ACL_KERNEL_NAME(TransformCast)
+#define FACLTelemetryScope ACL_KERNEL_NAME(FACLTelemetryScope)
+#define get_rounding_policy ACL_KERNEL_NAME(get_rounding_policy)
+#define GetQualitySeekParameters ACL_KERNEL_NAME(GetQualitySeekParameters)
+#define FACLTransform ACL_KERNEL_NAME(FACLTransform)
+#define FAtomIndices ACL_KERNEL_NAME(FAtomIndices)
+#define FUE4OutputWriter ACL_KERNEL_NAME(FUE4OutputWriter)
+#define UE4OutputTrackWriter ACL_KERNEL_NAME(UE4OutputTrackWriter)
+#define UE4DefaultDecompressionSettings ACL_KERNEL_NAME(UE4DefaultDecompressionSettings)
+#define UE4CustomDecompressionSettings ACL_KERNEL_NAME(UE4CustomDecompressionSettings)
+#define UE4SafeDecompressionSettings ACL_KERNEL_NAME(UE4SafeDecompressionSettings)
+#define UE4ManifestDecompressionSettings ACL_KERNEL_NAME(UE4ManifestDecompressionSettings)
+#define UE4CurveDecompressionSettings ACL_KERNEL_NAME(UE4CurveDecompressionSettings)
+#define UE4CurveWriter ACL_KERNEL_NAME(UE4CurveWriter)
+#define IsSupportedByFormatManifest ACL_KERNEL_NAME(IsSupportedByFormatManifest)
+#define DecompressBone ACL_KERNEL_NAME(DecompressBone)
+#define DecompressPoseAtTime ACL_KERNEL_NAME(DecompressPoseAtTime)
+#define DecompressPoseWithCache ACL_KERNEL_NAME(DecompressPoseWithCache)
+#define DecompressPose ACL_KERNEL_NAME(DecompressPose)
+
+#pragma clang attribute push(__attribute__((target(ACL_KERNEL_TARGET))), apply_to = function)
+
+namespace
+{
+#include "ACLDecompressionImpl.h"
+
+template<typename DecompressionSettingsType>
+void DecompressPoseKernel(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+{
+	DecompressPose<DecompressionSettingsType>(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+}
+
+template<typename DecompressionSettingsType>
+void DecompressBoneKernel(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom)
+{
+	DecompressBone<DecompressionSettingsType>(DecompContext, TrackIndex, OutAtom);
+}
+}
+
+#pragma clang attribute pop
+
+FACLDecompressionKernels ACL_KERNEL_NAME(GetACLDecompressionKernels)()
+{
+	// The instantiations keep the target attribute of the templates they come from
+	return
+	{
+		{ &DecompressPoseKernel<UE4DefaultDecompressionSettings>, &DecompressBoneKernel<UE4DefaultDecompressionSettings> },
+		{ &DecompressPoseKernel<UE4SafeDecompressionSettings>, &DecompressBoneKernel<UE4SafeDecompressionSettings> },
+		{ &DecompressPoseKernel<UE4CustomDecompressionSettings>, &DecompressBoneKernel<UE4CustomDecompressionSettings> },
+		{ &DecompressPoseKernel<UE4ManifestDecompressionSettings>, &DecompressBoneKernel<UE4ManifestDecompressionSettings> },
+	};
+}
+#endif
@@ -0,0 +1,15 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+// The ACL codec decoders built for AVX2 with FMA and POPCNT, see ACLDecompressionKernelsISA.inl
+
+#define ACL_KERNEL_SUFFIX AVX2
+#define ACL_KERNEL_TARGET "sse3,ssse3,sse4.1,sse4.2,avx,avx2,fma,popcnt"
+
+#define RTM_SSE3_INTRINSICS
+#define RTM_SSE4_INTRINSICS
+#define RTM_AVX_INTRINSICS
+#define RTM_AVX2_INTRINSICS
+#define RTM_FMA_INTRINSICS
+#define ACL_USE_POPCOUNT
+
+#include "ACLDecompressionKernelsISA.inl"
@@ -0,0 +1,12 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+// The ACL codec decoders built for SSE4.1 with POPCNT, see ACLDecompressionKernelsISA.inl
+
+#define ACL_KERNEL_SUFFIX SSE41
+#define ACL_KERNEL_TARGET "sse3,ssse3,sse4.1,popcnt"
+
+#define RTM_SSE3_INTRINSICS
+#define RTM_SSE4_INTRINSICS
+#define ACL_USE_POPCOUNT
+
+#include "ACLDecompressionKernelsISA.inl"
@@ -0,0 +1,21 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLDecompressionQuality.h"
+
+static thread_local EACLDecompressionQuality GACLDecompressionQuality = EACLDecompressionQuality::Full;
+
+FACLScopedDecompressionQuality::FACLScopedDecompressionQuality(EACLDecompressionQuality Quality)
+	: PreviousQuality(GACLDecompressionQuality)
+{
+	GACLDecompressionQuality = Quality;
+}
+
+FACLScopedDecompressionQuality::~FACLScopedDecompressionQuality()
+{
+	GACLDecompressionQuality = PreviousQuality;
+}
+
+EACLDecompressionQuality FACLScopedDecompressionQuality::GetCurrent()
+{
+	return GACLDecompressionQuality;
+}
@@ -0,0 +1,145 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLFormatManifest.h"
+
+#if WITH_EDITOR
+#include "AnimationCompression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+#include <acl/core/compressed_tracks.h>
+
+// The names must match those the build script parses
+static const TCHAR* GetFormatName(acl::rotation_format8 Format)
+{
+	switch (Format)
+	{
+	case acl::rotation_format8::quatf_full:				return TEXT("quatf_full");
+	case acl::rotation_format8::quatf_drop_w_full:		return TEXT("quatf_drop_w_full");
+	case acl::rotation_format8::quatf_drop_w_variable:	return TEXT("quatf_drop_w_variable");
+	default:											return nullptr;
+	}
+}
+
+static const TCHAR* GetFormatName(acl::vector_format8 Format)
+{
+	switch (Format)
+	{
+	case acl::vector_format8::vector3f_full:		return TEXT("vector3f_full");
+	case acl::vector_format8::vector3f_variable:	return TEXT("vector3f_variable");
+	default:										return nullptr;
+	}
+}
+
+struct FACLFormatManifest
+{
+	static constexpr int32 NumFormatTypes = 3;
+
+	FCriticalSection Lock;
+	TSet<FString> Formats[NumFormatTypes];
+	bool bIsLoaded = false;
+
+	static const TCHAR* GetKey(int32 FormatType)
+	{
+		static const TCHAR* Keys[NumFormatTypes] = { TEXT("RotationFormats"), TEXT("TranslationFormats"), TEXT("ScaleFormats") };
+		return Keys[FormatType];
+	}
+
+	static FString GetPath()
+	{
+		return FPaths::Combine(FPaths::ProjectConfigDir(), TEXT("ACLFormatManifest.ini"));
+	}
+
+	void Load()
+	{
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *GetPath());
+
+		for (const FString& Line : Lines)
+		{
+			FString Key;
+			FString Value;
+			if (!Line.Split(TEXT("="), &Key, &Value))
+			{
+				continue;
+			}
+
+			for (int32 FormatType = 0; FormatType < NumFormatTypes; ++FormatType)
+			{
+				if (Key.TrimStartAndEnd() == GetKey(FormatType))
+				{
+					TArray<FString> FormatNames;
+					Value.ParseIntoArray(FormatNames, TEXT(","));
+
+					for (const FString& FormatName : FormatNames)
+					{
+						Formats[FormatType].Add(FormatName.TrimStartAndEnd());
+					}
+				}
+			}
+		}
+
+		bIsLoaded = true;
+	}
+
+	void Save() const
+	{
+		FString Contents = TEXT("; Generated when cooking ACL compressed anim sequences, see ACLFormatManifest.h\n[ACLFormatManifest]\n");
+		for (int32 FormatType = 0; FormatType < NumFormatTypes; ++FormatType)
+		{
+			TArray<FString> FormatNames = Formats[FormatType].Array();
+			FormatNames.Sort();
+
+			Contents += FString::Printf(TEXT("%s=%s\n"), GetKey(FormatType), *FString::Join(FormatNames, TEXT(",")));
+		}
+
+		if (!FFileHelper::SaveStringToFile(Contents, *GetPath()))
+		{
+			UE_LOG(LogAnimationCompression, Warning, TEXT("Failed to write the ACL format manifest: %s"), *GetPath());
+		}
+	}
+};
+
+void RecordACLFormatUsage(const TArrayView<uint8>& CompressedByteStream)
+{
+	const acl::compressed_tracks* CompressedClipData = CompressedByteStream.Num() != 0 ? acl::make_compressed_tracks(CompressedByteStream.GetData()) : nullptr;
+	if (CompressedClipData == nullptr || CompressedClipData->get_track_type() != acl::track_type8::qvvf)
+	{
+		return;
+	}
+
+	const acl::acl_impl::tracks_header& TracksHeader = acl::acl_impl::get_tracks_header(*CompressedClipData);
+
+	const TCHAR* FormatNames[FACLFormatManifest::NumFormatTypes] =
+	{
+		GetFormatName(TracksHeader.get_rotation_format()),
+		GetFormatName(TracksHeader.get_translation_format()),
+		TracksHeader.get_has_scale() ? GetFormatName(TracksHeader.get_scale_format()) : nullptr,
+	};
+
+	static FACLFormatManifest Manifest;
+	FScopeLock ScopeLock(&Manifest.Lock);
+
+	if (!Manifest.bIsLoaded)
+	{
+		Manifest.Load();
+	}
+
+	bool bIsDirty = false;
+	for (int32 FormatType = 0; FormatType < FACLFormatManifest::NumFormatTypes; ++FormatType)
+	{
+		if (FormatNames[FormatType] != nullptr && !Manifest.Formats[FormatType].Contains(FormatNames[FormatType]))
+		{
+			Manifest.Formats[FormatType].Add(FormatNames[FormatType]);
+			bIsDirty = true;
+		}
+	}
+
+	// New formats are rare, most sequences use the same ones
+	if (bIsDirty)
+	{
+		Manifest.Save();
+	}
+}
+#endif
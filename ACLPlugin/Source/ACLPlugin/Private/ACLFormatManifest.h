@@ -0,0 +1,15 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_EDITOR
+/*
+ * The format manifest lists the rotation, translation, and scale formats used by the cooked ACLCustom content
+ * of the project. It lives in <Project>/Config/ACLFormatManifest.ini and is updated as ACLCustom anim sequences are cooked.
+ * When it is present, the plugin build script compiles the ACLCustom decoders with only those formats enabled.
+ * Formats are only ever added to it, delete it to start from scratch.
+ */
+void RecordACLFormatUsage(const TArrayView<uint8>& CompressedByteStream);
+#endif
@@ -4,6 +4,8 @@
 #include "IACLPluginModule.h"
 #include "Modules/ModuleManager.h"
 
+#include "ACLDecompressionKernels.h"
+
 // Enable console commands only in development builds when logging is enabled
 #define WITH_ACL_CONSOLE_COMMANDS (!UE_BUILD_SHIPPING && !UE_BUILD_TEST && !NO_LOGGING)
 
@@ -13,8 +15,21 @@
 #include "Animation/AnimBoneCompressionSettings.h"
 #include "Animation/AnimCurveCompressionCodec.h"
 #include "Animation/AnimCurveCompressionSettings.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/MemStack.h"
+#include "Misc/Paths.h"
 #include "UObject/UObjectIterator.h"
+
+#include "AnimBoneCompressionCodec_ACL.h"
+#include "AnimBoneCompressionCodec_ACLBase.h"
+#include "AnimBoneCompressionCodec_ACLCustom.h"
+#include "AnimBoneCompressionCodec_ACLSafe.h"
+#include "AnimCurveCompressionCodec_ACL.h"
+#include "ACLBatchDecompression.h"
+#include "ACLPoseCache.h"
 #endif
 
 class FACLPlugin final : public IACLPlugin
@@ -28,6 +43,13 @@ private:
 	// Console commands
 	void ListCodecs(const TArray<FString>& Args);
 	void ListAnimSequences(const TArray<FString>& Args);
+	void DumpPoseCacheStats(const TArray<FString>& Args);
+	void BenchmarkBatchDecompression(const TArray<FString>& Args);
+	void BenchmarkDecompressionISA(const TArray<FString>& Args);
+	void VerifyCurves(const TArray<FString>& Args);
+#if WITH_ACL_TELEMETRY
+	void DumpTelemetry(const TArray<FString>& Args);
+#endif
 
 	TArray<IConsoleObject*> ConsoleCommands;
 #endif
@@ -41,21 +63,22 @@ IMPLEMENT_MODULE(FACLPlugin, ACLPlugin)
 template<class ClassType>
 static TArray<ClassType*> GetObjectInstancesSorted()
 {
-	TArray<ClassType*> Results;
+	// Build the path names once, they are expensive to generate with large projects
+	TArray<TPair<FString, ClassType*>> NamedObjects;
 
 	for (TObjectIterator<ClassType> It; It; ++It)
 	{
-		Results.Add(*It);
+		NamedObjects.Emplace(It->GetPathName(), *It);
 	}
 
-	struct FCompareObjectNames
+	NamedObjects.Sort([](const TPair<FString, ClassType*>& Lhs, const TPair<FString, ClassType*>& Rhs) { return Lhs.Key.Compare(Rhs.Key) < 0; });
+
+	TArray<ClassType*> Results;
+	Results.Reserve(NamedObjects.Num());
+	for (const TPair<FString, ClassType*>& NamedObject : NamedObjects)
 	{
-		FORCEINLINE bool operator()(const ClassType& Lhs, const ClassType& Rhs) const
-		{
-			return Lhs.GetPathName().Compare(Rhs.GetPathName()) < 0;
-		}
-	};
-	Results.Sort(FCompareObjectNames());
+		Results.Add(NamedObject.Value);
+	}
 
 	return Results;
 }
@@ -93,6 +116,37 @@ static SIZE_T GetCompressedCurveSize(const FCompressedAnimSequence& CompressedDa
 	return Size;
 }
 
+struct FCodecUsage
+{
+	int32 NumReferences = 0;
+	SIZE_T UsedSize = 0;
+};
+
+static void LogCodecUsage(const TCHAR* Category, const UObject* Object, const FString& Description, const TMap<const UObject*, FCodecUsage>& UsageMap, int32 NumAnimSequences, SIZE_T TotalSize, FString* CSVOutput)
+{
+	const FCodecUsage* Usage = UsageMap.Find(Object);
+	const int32 NumReferences = Usage != nullptr ? Usage->NumReferences : 0;
+	const SIZE_T UsedSize = Usage != nullptr ? Usage->UsedSize : 0;
+	const FString PathName = Object->GetPathName();
+
+	if (Description.IsEmpty())
+	{
+		UE_LOG(LogAnimationCompression, Log, TEXT("%s ..."), *PathName);
+	}
+	else
+	{
+		UE_LOG(LogAnimationCompression, Log, TEXT("%s (%s) ..."), *PathName, *Description);
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("    used by %d / %d (%.1f %%) anim sequences"), NumReferences, NumAnimSequences, Percentage(NumReferences, NumAnimSequences));
+	UE_LOG(LogAnimationCompression, Log, TEXT("    uses %.2f MB / %.2f MB (%.1f %%)"), BytesToMB(UsedSize), BytesToMB(TotalSize), Percentage(UsedSize, TotalSize));
+
+	if (CSVOutput != nullptr)
+	{
+		*CSVOutput += FString::Printf(TEXT("%s,%s,\"%s\",%d,%d,%llu,%llu\n"), Category, *PathName, *Description.Replace(TEXT("\""), TEXT("'")), NumReferences, NumAnimSequences, uint64(UsedSize), uint64(TotalSize));
+	}
+}
+
 void FACLPlugin::ListCodecs(const TArray<FString>& Args)
 {
 	// Turn off log times to make diffing easier
@@ -106,102 +160,90 @@ void FACLPlugin::ListCodecs(const TArray<FString>& Args)
 	const TArray<UAnimBoneCompressionCodec*> BoneCodecs = GetObjectInstancesSorted<UAnimBoneCompressionCodec>();
 	const TArray<UAnimCurveCompressionSettings*> CurveSettings = GetObjectInstancesSorted<UAnimCurveCompressionSettings>();
 	const TArray<UAnimCurveCompressionCodec*> CurveCodecs = GetObjectInstancesSorted<UAnimCurveCompressionCodec>();
-	const TArray<UAnimSequence*> AnimSequences = GetObjectInstancesSorted<UAnimSequence>();
 
-	UE_LOG(LogAnimationCompression, Log, TEXT("===== Bone Compression Setting Assets ====="));
-	for (const UAnimBoneCompressionSettings* Settings : BoneSettings)
+	// Gather the usage of every settings asset and codec in a single pass over the anim sequences
+	TMap<const UObject*, FCodecUsage> BoneSettingsUsage;
+	TMap<const UObject*, FCodecUsage> BoneCodecUsage;
+	TMap<const UObject*, FCodecUsage> CurveSettingsUsage;
+	TMap<const UObject*, FCodecUsage> CurveCodecUsage;
+	SIZE_T TotalBoneSize = 0;
+	SIZE_T TotalCurveSize = 0;
+	int32 NumAnimSequences = 0;
+
+	for (TObjectIterator<UAnimSequence> It; It; ++It)
 	{
-		int32 NumReferences = 0;
-		SIZE_T TotalSize = 0;
-		SIZE_T UsedSize = 0;
-		for (const UAnimSequence* AnimSeq : AnimSequences)
+		const UAnimSequence* AnimSeq = *It;
+		const SIZE_T BoneSize = GetCompressedBoneSize(AnimSeq->CompressedData);
+		const SIZE_T CurveSize = GetCompressedCurveSize(AnimSeq->CompressedData);
+
+		auto AddUsage = [](TMap<const UObject*, FCodecUsage>& UsageMap, const UObject* Object, SIZE_T Size)
 		{
-			const SIZE_T Size = GetCompressedBoneSize(AnimSeq->CompressedData);
-			if (AnimSeq->BoneCompressionSettings == Settings)
-			{
-				NumReferences++;
-				UsedSize += Size;
-			}
-			TotalSize += Size;
-		}
+			FCodecUsage& Usage = UsageMap.FindOrAdd(Object);
+			Usage.NumReferences++;
+			Usage.UsedSize += Size;
+		};
+
+		AddUsage(BoneSettingsUsage, AnimSeq->BoneCompressionSettings, BoneSize);
+		AddUsage(BoneCodecUsage, AnimSeq->CompressedData.BoneCompressionCodec, BoneSize);
+		AddUsage(CurveSettingsUsage, AnimSeq->CurveCompressionSettings, CurveSize);
+		AddUsage(CurveCodecUsage, AnimSeq->CompressedData.CurveCompressionCodec, CurveSize);
+
+		TotalBoneSize += BoneSize;
+		TotalCurveSize += CurveSize;
+		NumAnimSequences++;
+	}
 
-		UE_LOG(LogAnimationCompression, Log, TEXT("%s ..."), *Settings->GetPathName());
-		UE_LOG(LogAnimationCompression, Log, TEXT("    used by %d / %d (%.1f %%) anim sequences"), NumReferences, AnimSequences.Num(), Percentage(NumReferences, AnimSequences.Num()));
-		UE_LOG(LogAnimationCompression, Log, TEXT("    uses %.2f MB / %.2f MB (%.1f %%)"), BytesToMB(UsedSize), BytesToMB(TotalSize), Percentage(UsedSize, TotalSize));
+	// Optionally export everything in CSV format for automated memory reports
+	const FString* CSVArg = Args.FindByPredicate([](const FString& Arg) { return Arg.StartsWith(TEXT("csv")); });
+	FString CSVOutput;
+	FString* CSVOutputPtr = nullptr;
+	if (CSVArg != nullptr)
+	{
+		CSVOutput = TEXT("Category,Path,Description,Num References,Num Anim Sequences,Used Size,Total Size\n");
+		CSVOutputPtr = &CSVOutput;
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("===== Bone Compression Setting Assets ====="));
+	for (const UAnimBoneCompressionSettings* Settings : BoneSettings)
+	{
+		LogCodecUsage(TEXT("BoneSettings"), Settings, FString(), BoneSettingsUsage, NumAnimSequences, TotalBoneSize, CSVOutputPtr);
 	}
 
 	UE_LOG(LogAnimationCompression, Log, TEXT("===== Bone Compression Codecs ====="));
 	for (const UAnimBoneCompressionCodec* Codec : BoneCodecs)
 	{
-		int32 NumReferences = 0;
-		SIZE_T TotalSize = 0;
-		SIZE_T UsedSize = 0;
-		for (const UAnimSequence* AnimSeq : AnimSequences)
-		{
-			const SIZE_T Size = GetCompressedBoneSize(AnimSeq->CompressedData);
-			if (AnimSeq->CompressedData.BoneCompressionCodec == Codec)
-			{
-				NumReferences++;
-				UsedSize += Size;
-			}
-			TotalSize += Size;
-		}
-
-		if (Codec->Description.IsEmpty())
-		{
-			UE_LOG(LogAnimationCompression, Log, TEXT("%s ..."), *Codec->GetPathName());
-		}
-		else
-		{
-			UE_LOG(LogAnimationCompression, Log, TEXT("%s (%s) ..."), *Codec->GetPathName(), *Codec->Description);
-		}
-
-		UE_LOG(LogAnimationCompression, Log, TEXT("    used by %d / %d (%.1f %%) anim sequences"), NumReferences, AnimSequences.Num(), Percentage(NumReferences, AnimSequences.Num()));
-		UE_LOG(LogAnimationCompression, Log, TEXT("    uses %.2f MB / %.2f MB (%.1f %%)"), BytesToMB(UsedSize), BytesToMB(TotalSize), Percentage(UsedSize, TotalSize));
+		LogCodecUsage(TEXT("BoneCodec"), Codec, Codec->Description, BoneCodecUsage, NumAnimSequences, TotalBoneSize, CSVOutputPtr);
 	}
 
 	UE_LOG(LogAnimationCompression, Log, TEXT("===== Curve Compression Setting Assets ====="));
 	for (const UAnimCurveCompressionSettings* Settings : CurveSettings)
 	{
-		int32 NumReferences = 0;
-		SIZE_T TotalSize = 0;
-		SIZE_T UsedSize = 0;
-		for (const UAnimSequence* AnimSeq : AnimSequences)
-		{
-			const SIZE_T Size = GetCompressedCurveSize(AnimSeq->CompressedData);
-			if (AnimSeq->CurveCompressionSettings == Settings)
-			{
-				NumReferences++;
-				UsedSize += Size;
-			}
-			TotalSize += Size;
-		}
-
-		UE_LOG(LogAnimationCompression, Log, TEXT("%s ..."), *Settings->GetPathName());
-		UE_LOG(LogAnimationCompression, Log, TEXT("    used by %d / %d (%.1f %%) anim sequences"), NumReferences, AnimSequences.Num(), Percentage(NumReferences, AnimSequences.Num()));
-		UE_LOG(LogAnimationCompression, Log, TEXT("    uses %.2f MB / %.2f MB (%.1f %%)"), BytesToMB(UsedSize), BytesToMB(TotalSize), Percentage(UsedSize, TotalSize));
+		LogCodecUsage(TEXT("CurveSettings"), Settings, FString(), CurveSettingsUsage, NumAnimSequences, TotalCurveSize, CSVOutputPtr);
 	}
 
 	UE_LOG(LogAnimationCompression, Log, TEXT("===== Curve Compression Codecs ====="));
 	for (const UAnimCurveCompressionCodec* Codec : CurveCodecs)
 	{
-		int32 NumReferences = 0;
-		SIZE_T TotalSize = 0;
-		SIZE_T UsedSize = 0;
-		for (const UAnimSequence* AnimSeq : AnimSequences)
+		LogCodecUsage(TEXT("CurveCodec"), Codec, FString(), CurveCodecUsage, NumAnimSequences, TotalCurveSize, CSVOutputPtr);
+	}
+
+	if (CSVArg != nullptr)
+	{
+		// Either csv=<path> or csv to write in the profiling directory
+		FString CSVPath;
+		if (!CSVArg->Split(TEXT("="), nullptr, &CSVPath) || CSVPath.IsEmpty())
 		{
-			const SIZE_T Size = GetCompressedCurveSize(AnimSeq->CompressedData);
-			if (AnimSeq->CompressedData.CurveCompressionCodec == Codec)
-			{
-				NumReferences++;
-				UsedSize += Size;
-			}
-			TotalSize += Size;
+			CSVPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("ACL"), FString::Printf(TEXT("ListCodecs-%s.csv"), *FDateTime::Now().ToString()));
 		}
 
-		UE_LOG(LogAnimationCompression, Log, TEXT("%s ..."), *Codec->GetPathName());
-		UE_LOG(LogAnimationCompression, Log, TEXT("    used by %d / %d (%.1f %%) anim sequences"), NumReferences, AnimSequences.Num(), Percentage(NumReferences, AnimSequences.Num()));
-		UE_LOG(LogAnimationCompression, Log, TEXT("    uses %.2f MB / %.2f MB (%.1f %%)"), BytesToMB(UsedSize), BytesToMB(TotalSize), Percentage(UsedSize, TotalSize));
+		if (FFileHelper::SaveStringToFile(CSVOutput, *CSVPath))
+		{
+			UE_LOG(LogAnimationCompression, Log, TEXT("Codec statistics written to: %s"), *CSVPath);
+		}
+		else
+		{
+			UE_LOG(LogAnimationCompression, Warning, TEXT("Failed to write codec statistics to: %s"), *CSVPath);
+		}
 	}
 
 	LogAnimationCompression.SetVerbosity(OldVerbosity);
@@ -259,16 +301,430 @@ void FACLPlugin::ListAnimSequences(const TArray<FString>& Args)
 
 	LogAnimationCompression.SetVerbosity(OldVerbosity);
 }
+
+#if WITH_ACL_TELEMETRY
+void FACLPlugin::DumpTelemetry(const TArray<FString>& Args)
+{
+	struct FSequenceTelemetry
+	{
+		const UAnimSequence* AnimSeq;
+		const FACLCompressedAnimData* AnimData;
+		int64 DecompressionCycles;
+	};
+
+	TArray<FSequenceTelemetry> Entries;
+	for (TObjectIterator<UAnimSequence> It; It; ++It)
+	{
+		const UAnimSequence* AnimSeq = *It;
+		if (AnimSeq->CompressedData.BoneCompressionCodec == nullptr || !AnimSeq->CompressedData.BoneCompressionCodec->IsA<UAnimBoneCompressionCodec_ACLBase>() || !AnimSeq->CompressedData.CompressedDataStructure)
+		{
+			continue;
+		}
+
+		const FACLCompressedAnimData* AnimData = static_cast<const FACLCompressedAnimData*>(AnimSeq->CompressedData.CompressedDataStructure.Get());
+		Entries.Add({ AnimSeq, AnimData, AnimData->Telemetry.DecompressionCycles.GetValue() });
+	}
+
+	if (Args.Contains(TEXT("reset")))
+	{
+		for (const FSequenceTelemetry& Entry : Entries)
+		{
+			Entry.AnimData->Telemetry.Reset();
+		}
+
+		UE_LOG(LogAnimationCompression, Log, TEXT("ACL telemetry reset for %d anim sequences"), Entries.Num());
+		return;
+	}
+
+	// Turn off log times to make diffing easier
+	TGuardValue<ELogTimes::Type> DisableLogTimes(GPrintLogTimes, ELogTimes::None);
+
+	// Make sure to log everything
+	const ELogVerbosity::Type OldVerbosity = LogAnimationCompression.GetVerbosity();
+	LogAnimationCompression.SetVerbosity(ELogVerbosity::All);
+
+	if (GACLEnableTelemetry == 0)
+	{
+		UE_LOG(LogAnimationCompression, Log, TEXT("ACL telemetry is disabled, enable it with: ACL.EnableTelemetry 1"));
+	}
+
+	// Most expensive first
+	Entries.Sort([](const FSequenceTelemetry& Lhs, const FSequenceTelemetry& Rhs) { return Lhs.DecompressionCycles > Rhs.DecompressionCycles; });
+
+	const bool bListUnused = Args.Contains(TEXT("unused"));
+
+	int32 MaxNumEntries = 50;
+	for (const FString& Arg : Args)
+	{
+		if (Arg.IsNumeric())
+		{
+			MaxNumEntries = FCString::Atoi(*Arg);
+		}
+	}
+
+	int32 NumUnused = 0;
+	SIZE_T UnusedSize = 0;
+	int32 NumListed = 0;
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("===== ACL Decompression Telemetry ====="));
+	for (const FSequenceTelemetry& Entry : Entries)
+	{
+		const FACLDecompressionTelemetry& Telemetry = Entry.AnimData->Telemetry;
+		const int64 NumCalls = Telemetry.NumDecompressionCalls.GetValue();
+		const SIZE_T Size = GetCompressedBoneSize(Entry.AnimSeq->CompressedData);
+
+		if (NumCalls == 0)
+		{
+			NumUnused++;
+			UnusedSize += Size;
+		}
+
+		if ((NumCalls == 0) != bListUnused || NumListed >= MaxNumEntries)
+		{
+			continue;
+		}
+
+		NumListed++;
+		UE_LOG(LogAnimationCompression, Log, TEXT("%s ..."), *Entry.AnimSeq->GetPathName());
+		UE_LOG(LogAnimationCompression, Log, TEXT("    has %.2f KB of bone data"), BytesToKB(Size));
+
+		if (NumCalls != 0)
+		{
+			const double TotalTimeMS = FPlatformTime::ToMilliseconds64(Entry.DecompressionCycles);
+			UE_LOG(LogAnimationCompression, Log, TEXT("    decompressed %lld times in %.3f ms (%.2f us per call)"), NumCalls, TotalTimeMS, (TotalTimeMS * 1000.0) / double(NumCalls));
+			UE_LOG(LogAnimationCompression, Log, TEXT("    touched up to %.2f MB"), BytesToMB(Telemetry.NumBytesTouched.GetValue()));
+			UE_LOG(LogAnimationCompression, Log, TEXT("    last used %lld frames ago"), int64(GFrameCounter) - Telemetry.LastUsedFrame.GetValue());
+		}
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("%d / %d (%.1f %%) ACL anim sequences were never decompressed, they use %.2f MB"), NumUnused, Entries.Num(), Percentage(NumUnused, Entries.Num()), BytesToMB(UnusedSize));
+
+	LogAnimationCompression.SetVerbosity(OldVerbosity);
+}
+#endif
+
+void FACLPlugin::DumpPoseCacheStats(const TArray<FString>& Args)
+{
+	FACLPoseCache& PoseCache = FACLPoseCache::Get();
+
+	if (Args.Contains(TEXT("reset")))
+	{
+		PoseCache.Reset();
+		UE_LOG(LogAnimationCompression, Log, TEXT("ACL pose cache reset"));
+		return;
+	}
+
+	const FACLPoseCacheStats Stats = PoseCache.GetStats();
+	const int64 NumLookups = Stats.NumHits + Stats.NumMisses;
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("===== ACL Pose Cache ====="));
+	UE_LOG(LogAnimationCompression, Log, TEXT("Enabled: %s"), GACLPoseCacheEnabled != 0 ? TEXT("true") : TEXT("false"));
+	UE_LOG(LogAnimationCompression, Log, TEXT("Hits: %lld / %lld (%.1f %%)"), Stats.NumHits, NumLookups, Percentage(Stats.NumHits, NumLookups));
+	UE_LOG(LogAnimationCompression, Log, TEXT("Evictions: %lld"), Stats.NumEvictions);
+	UE_LOG(LogAnimationCompression, Log, TEXT("Cached poses: %d"), Stats.NumEntries);
+	UE_LOG(LogAnimationCompression, Log, TEXT("Memory: %.2f KB / %.2f KB"), BytesToKB(Stats.UsedMemory), BytesToKB(Stats.MemoryBudget));
+}
+
+// Number of times every batch is decompressed, the fastest run is reported
+static constexpr int32 NumBatchBenchmarkIterations = 5;
+
+void FACLPlugin::BenchmarkBatchDecompression(const TArray<FString>& Args)
+{
+	TArray<int32> InstanceCounts;
+	for (const FString& Arg : Args)
+	{
+		if (Arg.IsNumeric())
+		{
+			InstanceCounts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+		}
+	}
+
+	if (InstanceCounts.Num() == 0)
+	{
+		InstanceCounts = { 100, 250, 500, 1000, 2500, 5000 };
+	}
+
+	// Every instance plays a sequence from those currently loaded, like a crowd would
+	struct FBenchmarkSequence
+	{
+		const UAnimSequence* AnimSeq;
+		BoneTrackArray RotationPairs;
+		BoneTrackArray TranslationPairs;
+		BoneTrackArray ScalePairs;
+	};
+
+	TArray<FBenchmarkSequence> Sequences;
+	for (const UAnimSequence* AnimSeq : GetObjectInstancesSorted<UAnimSequence>())
+	{
+		const UAnimBoneCompressionCodec* Codec = AnimSeq->CompressedData.BoneCompressionCodec;
+		if (Codec == nullptr || !Codec->IsA<UAnimBoneCompressionCodec_ACLBase>() || !AnimSeq->CompressedData.CompressedDataStructure || !AnimSeq->CompressedData.CompressedDataStructure->IsValid())
+		{
+			continue;
+		}
+
+		const int32 NumTracks = AnimSeq->CompressedData.CompressedTrackToSkeletonMapTable.Num();
+		if (NumTracks == 0)
+		{
+			continue;
+		}
+
+		FBenchmarkSequence& Sequence = Sequences.AddDefaulted_GetRef();
+		Sequence.AnimSeq = AnimSeq;
+		for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+		{
+			Sequence.RotationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+			Sequence.TranslationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+		}
+
+		Sequence.ScalePairs = Sequence.RotationPairs;
+	}
+
+	if (Sequences.Num() == 0)
+	{
+		UE_LOG(LogAnimationCompression, Log, TEXT("No ACL anim sequence is loaded, nothing to benchmark"));
+		return;
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("===== ACL Batch Decompression Benchmark ====="));
+	UE_LOG(LogAnimationCompression, Log, TEXT("%d anim sequences, %d worker threads"), Sequences.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+	for (int32 NumInstances : InstanceCounts)
+	{
+		// Use a fixed seed so every run samples the same poses
+		FRandomStream RandomStream(NumInstances);
+
+		TArray<TArray<FTransform>> Poses;
+		Poses.SetNum(NumInstances);
+
+		TArray<FACLPoseDecompressionRequest> Requests;
+		Requests.Reserve(NumInstances);
+
+		for (int32 InstanceIndex = 0; InstanceIndex < NumInstances; ++InstanceIndex)
+		{
+			const FBenchmarkSequence& Sequence = Sequences[RandomStream.RandHelper(Sequences.Num())];
+			Poses[InstanceIndex].AddDefaulted(Sequence.RotationPairs.Num());
+
+			FACLPoseDecompressionRequest& Request = Requests.AddDefaulted_GetRef();
+			Request.AnimSeq = Sequence.AnimSeq;
+			Request.Time = RandomStream.FRandRange(0.0f, Sequence.AnimSeq->SequenceLength);
+			Request.RotationPairs = &Sequence.RotationPairs;
+			Request.TranslationPairs = &Sequence.TranslationPairs;
+			Request.ScalePairs = &Sequence.ScalePairs;
+			Request.OutAtoms = Poses[InstanceIndex];
+		}
+
+		uint64 BestSequentialCycles = MAX_uint64;
+		uint64 BestBatchCycles = MAX_uint64;
+
+		for (int32 Iteration = 0; Iteration < NumBatchBenchmarkIterations; ++Iteration)
+		{
+			// One pose after the other in instance order, like the engine does today on a single thread
+			{
+				FMemMark Mark(FMemStack::Get());
+
+				const uint64 StartTimeCycles = FPlatformTime::Cycles64();
+				for (const FACLPoseDecompressionRequest& Request : Requests)
+				{
+					const UAnimSequence* AnimSeq = Request.AnimSeq;
+					FAnimSequenceDecompressionContext DecompContext(AnimSeq->SequenceLength, AnimSeq->Interpolation, AnimSeq->GetFName(), *AnimSeq->CompressedData.CompressedDataStructure);
+					DecompContext.Seek(Request.Time);
+
+					TArrayView<FTransform> OutAtoms = Request.OutAtoms;
+					AnimSeq->CompressedData.BoneCompressionCodec->DecompressPose(DecompContext, *Request.RotationPairs, *Request.TranslationPairs, *Request.ScalePairs, OutAtoms);
+				}
+				BestSequentialCycles = FMath::Min(BestSequentialCycles, FPlatformTime::Cycles64() - StartTimeCycles);
+			}
+
+			{
+				const uint64 StartTimeCycles = FPlatformTime::Cycles64();
+				DecompressPoseBatch(Requests);
+				BestBatchCycles = FMath::Min(BestBatchCycles, FPlatformTime::Cycles64() - StartTimeCycles);
+			}
+		}
+
+		const double SequentialTimeMS = FPlatformTime::ToMilliseconds64(BestSequentialCycles);
+		const double BatchTimeMS = FPlatformTime::ToMilliseconds64(BestBatchCycles);
+
+		UE_LOG(LogAnimationCompression, Log, TEXT("%d instances: sequential %.3f ms, batch %.3f ms (%.2fx), %.2f us per pose"),
+			NumInstances, SequentialTimeMS, BatchTimeMS, BatchTimeMS > 0.0 ? SequentialTimeMS / BatchTimeMS : 0.0, (BatchTimeMS * 1000.0) / double(NumInstances));
+	}
+}
+
+// Number of times every pose is decompressed with each instruction set, the fastest run is reported
+static constexpr int32 NumISABenchmarkPasses = 5;
+
+/** Returns the decoder the codec of the anim sequence uses, nullptr if it isn't an ACL codec. */
+static const FACLDecoderKernels* GetDecoderKernels(const FACLDecompressionKernels& Kernels, const UAnimSequence& AnimSeq)
+{
+	const UAnimBoneCompressionCodec* Codec = AnimSeq.CompressedData.BoneCompressionCodec;
+	if (Codec == nullptr || !AnimSeq.CompressedData.CompressedDataStructure || !AnimSeq.CompressedData.CompressedDataStructure->IsValid())
+	{
+		return nullptr;
+	}
+
+	if (Codec->IsA<UAnimBoneCompressionCodec_ACL>())
+	{
+		return &Kernels.Default;
+	}
+	else if (Codec->IsA<UAnimBoneCompressionCodec_ACLSafe>())
+	{
+		return &Kernels.Safe;
+	}
+	else if (Codec->IsA<UAnimBoneCompressionCodec_ACLCustom>())
+	{
+#if ACL_WITH_FORMAT_MANIFEST
+		if (static_cast<const FACLCompressedAnimData&>(*AnimSeq.CompressedData.CompressedDataStructure).bIsSupportedByFormatManifest)
+		{
+			return &Kernels.Manifest;
+		}
+#endif
+
+		return &Kernels.Custom;
+	}
+
+	return nullptr;
+}
+
+void FACLPlugin::BenchmarkDecompressionISA(const TArray<FString>& Args)
+{
+	TArray<UAnimSequence*> AnimSequences;
+	for (UAnimSequence* AnimSeq : GetObjectInstancesSorted<UAnimSequence>())
+	{
+		if (GetDecoderKernels(GACLDecompressionKernels, *AnimSeq) != nullptr)
+		{
+			AnimSequences.Add(AnimSeq);
+		}
+	}
+
+	if (AnimSequences.Num() == 0)
+	{
+		UE_LOG(LogAnimationCompression, Log, TEXT("No anim sequence using an ACL codec is loaded, nothing to benchmark"));
+		return;
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("===== ACL Decompression Instruction Set Benchmark ====="));
+	UE_LOG(LogAnimationCompression, Log, TEXT("%d anim sequences, %s is used at runtime"), AnimSequences.Num(), GetACLDecompressionISAName(GetActiveACLDecompressionISA()));
+
+	double BaselineTimeMS = 0.0;
+	for (int32 ISAIndex = 0; ISAIndex < int32(EACLDecompressionISA::Count); ++ISAIndex)
+	{
+		const EACLDecompressionISA ISA = EACLDecompressionISA(ISAIndex);
+		const FACLDecompressionKernels* Kernels = GetACLDecompressionKernels(ISA);
+		if (Kernels == nullptr)
+		{
+			UE_LOG(LogAnimationCompression, Log, TEXT("%s: not supported"), GetACLDecompressionISAName(ISA));
+			continue;
+		}
+
+		uint64 TotalCycles = 0;
+		int64 NumPoses = 0;
+
+		for (const UAnimSequence* AnimSeq : AnimSequences)
+		{
+			const int32 NumTracks = AnimSeq->CompressedData.CompressedTrackToSkeletonMapTable.Num();
+			const int32 NumFrames = FMath::Max(AnimSeq->GetRawNumberOfFrames(), 1);
+
+			BoneTrackArray RotationPairs;
+			BoneTrackArray TranslationPairs;
+			for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+			{
+				RotationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+				TranslationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+			}
+
+			const BoneTrackArray& ScalePairs = RotationPairs;
+
+			TArray<FTransform> Atoms;
+			Atoms.AddDefaulted(NumTracks);
+			TArrayView<FTransform> OutAtoms(Atoms);
+
+			const FACLDecoderKernels* Decoder = GetDecoderKernels(*Kernels, *AnimSeq);
+			FAnimSequenceDecompressionContext DecompContext(AnimSeq->SequenceLength, AnimSeq->Interpolation, AnimSeq->GetFName(), *AnimSeq->CompressedData.CompressedDataStructure);
+
+			uint64 BestCycles = MAX_uint64;
+			for (int32 Pass = 0; Pass < NumISABenchmarkPasses; ++Pass)
+			{
+				FMemMark Mark(FMemStack::Get());
+
+				const uint64 StartTimeCycles = FPlatformTime::Cycles64();
+				for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+				{
+					DecompContext.Seek(NumFrames > 1 ? (AnimSeq->SequenceLength * FrameIndex) / (NumFrames - 1) : 0.0f);
+					Decoder->DecompressPose(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+				}
+				BestCycles = FMath::Min(BestCycles, FPlatformTime::Cycles64() - StartTimeCycles);
+			}
+
+			TotalCycles += BestCycles;
+			NumPoses += NumFrames;
+		}
+
+		const double TotalTimeMS = FPlatformTime::ToMilliseconds64(TotalCycles);
+		if (ISA == EACLDecompressionISA::Baseline)
+		{
+			BaselineTimeMS = TotalTimeMS;
+		}
+
+		UE_LOG(LogAnimationCompression, Log, TEXT("%s: %lld poses in %.3f ms, %.1f ns per pose (%.2fx)"),
+			GetACLDecompressionISAName(ISA), NumPoses, TotalTimeMS, (TotalTimeMS * 1.0e6) / double(NumPoses), TotalTimeMS > 0.0 ? BaselineTimeMS / TotalTimeMS : 0.0);
+	}
+}
+
+void FACLPlugin::VerifyCurves(const TArray<FString>& Args)
+{
+	UE_LOG(LogAnimationCompression, Log, TEXT("===== ACL Curves ====="));
+
+	int32 NumAnimSequences = 0;
+	int32 NumFailures = 0;
+	for (const UAnimSequence* AnimSeq : GetObjectInstancesSorted<UAnimSequence>())
+	{
+		const UAnimCurveCompressionCodec* Codec = AnimSeq->CompressedData.CurveCompressionCodec;
+		const TArray<FFloatCurve>& FloatCurves = AnimSeq->GetCurveData().FloatCurves;
+		if (Codec == nullptr || !Codec->IsA<UAnimCurveCompressionCodec_ACL>() || FloatCurves.Num() == 0)
+		{
+			continue;
+		}
+
+		NumAnimSequences++;
+
+		// When the compressed curves are invalid, the engine silently evaluates the raw curves or nothing at all
+		if (!AnimSeq->IsCurveCompressedDataValid())
+		{
+			UE_LOG(LogAnimationCompression, Warning, TEXT("%s: the compressed curves are missing"), *AnimSeq->GetPathName());
+			NumFailures++;
+			continue;
+		}
+
+		// Evaluate every curve through the codec at every frame and compare with the raw curves
+		const int32 NumFrames = FMath::Max(AnimSeq->GetRawNumberOfFrames(), 1);
+		float MaxError = 0.0f;
+		for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+		{
+			const float SampleTime = NumFrames > 1 ? (AnimSeq->SequenceLength * FrameIndex) / (NumFrames - 1) : 0.0f;
+			for (const FFloatCurve& Curve : FloatCurves)
+			{
+				const float CompressedValue = Codec->DecompressCurve(AnimSeq->CompressedData, Curve.Name.UID, SampleTime);
+				MaxError = FMath::Max(MaxError, FMath::Abs(CompressedValue - Curve.Evaluate(SampleTime)));
+			}
+		}
+
+		UE_LOG(LogAnimationCompression, Log, TEXT("%s: %d curves, %d frames, max error %f"), *AnimSeq->GetPathName(), FloatCurves.Num(), NumFrames, MaxError);
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("%d anim sequences use the ACL curve codec, %d have missing compressed curves"), NumAnimSequences, NumFailures);
+}
 #endif
 
 void FACLPlugin::StartupModule()
 {
+	InitACLDecompressionKernels();
+
 #if WITH_ACL_CONSOLE_COMMANDS
 	if (!IsRunningCommandlet())
 	{
 		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
 			TEXT("ACL.ListCodecs"),
-			TEXT("Dumps statistics about animation codecs to the log."),
+			TEXT("Dumps statistics about animation codecs to the log. Arguments: [csv[=<path>]] to also export them in CSV format."),
 			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::ListCodecs),
 			ECVF_Default
 		));
@@ -279,6 +735,43 @@ void FACLPlugin::StartupModule()
 			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::ListAnimSequences),
 			ECVF_Default
 		));
+
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.PoseCacheStats"),
+			TEXT("Dumps the hit rate and memory usage of the ACL pose cache to the log. Arguments: [reset]."),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::DumpPoseCacheStats),
+			ECVF_Default
+		));
+
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.BenchmarkBatchDecompression"),
+			TEXT("Compares sequential and batched pose decompression of the loaded ACL anim sequences. Arguments: [instance counts...], defaults to 100 250 500 1000 2500 5000."),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::BenchmarkBatchDecompression),
+			ECVF_Default
+		));
+
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.BenchmarkDecompressionISA"),
+			TEXT("Compares the decompression speed of the decoders of the ACL codecs built for each instruction set supported by the CPU."),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::BenchmarkDecompressionISA),
+			ECVF_Default
+		));
+
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.VerifyCurves"),
+			TEXT("Evaluates the compressed curves of the loaded anim sequences that use the ACL curve codec and compares them with the raw curves."),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::VerifyCurves),
+			ECVF_Default
+		));
+
+#if WITH_ACL_TELEMETRY
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.Telemetry"),
+			TEXT("Dumps the decompression statistics of ACL anim sequences to the log, most expensive first. Arguments: [max entries] [unused] [reset]. Requires ACL.EnableTelemetry 1."),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::DumpTelemetry),
+			ECVF_Default
+		));
+#endif
 	}
 #endif
 }
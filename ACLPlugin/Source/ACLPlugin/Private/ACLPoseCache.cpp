@@ -0,0 +1,210 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLPoseCache.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+
+#include "ACLDecompressionQuality.h"
+#include "AnimBoneCompressionCodec_ACLBase.h"
+
+int32 GACLPoseCacheEnabled = 0;
+static FAutoConsoleVariableRef CVarACLPoseCacheEnabled(
+	TEXT("ACL.PoseCache.Enable"),
+	GACLPoseCacheEnabled,
+	TEXT("Whether decompressed ACL poses are cached and shared by instances that sample the same anim sequence at nearly the same time. Sample times are snapped to ACL.PoseCache.TimeQuantum."),
+	ECVF_Default);
+
+static float GACLPoseCacheTimeQuantum = 1.0f / 60.0f;
+static FAutoConsoleVariableRef CVarACLPoseCacheTimeQuantum(
+	TEXT("ACL.PoseCache.TimeQuantum"),
+	GACLPoseCacheTimeQuantum,
+	TEXT("The time in seconds that cached pose sample times are snapped to (default: 1/60)."),
+	ECVF_Default);
+
+static int32 GACLPoseCacheMemoryBudgetKB = 4096;
+static FAutoConsoleVariableRef CVarACLPoseCacheMemoryBudgetKB(
+	TEXT("ACL.PoseCache.MemoryBudgetKB"),
+	GACLPoseCacheMemoryBudgetKB,
+	TEXT("The maximum amount of memory in KB used by cached poses (default: 4096)."),
+	ECVF_Default);
+
+// The LRU cache has a fixed capacity, the memory budget is what normally limits the number of poses
+static constexpr int32 MaxNumCachedPoses = 32 * 1024;
+
+static SIZE_T GetMemoryBudget()
+{
+	return SIZE_T(FMath::Max(GACLPoseCacheMemoryBudgetKB, 0)) * 1024;
+}
+
+FACLPoseCache& FACLPoseCache::Get()
+{
+	static FACLPoseCache PoseCache;
+	return PoseCache;
+}
+
+FACLPoseCache::FShard::FShard()
+	: Cache(MaxNumCachedPoses / NumShards)
+{
+}
+
+bool FACLPoseCache::FCachedPose::HasTracks(const BoneTrackArray& RotationPairs_, const BoneTrackArray& TranslationPairs_, const BoneTrackArray& ScalePairs_) const
+{
+	const auto IsSame = [](const TArray<BoneTrackPair>& CachedPairs, const BoneTrackArray& Pairs)
+	{
+		return CachedPairs.Num() == Pairs.Num() && FMemory::Memcmp(CachedPairs.GetData(), Pairs.GetData(), Pairs.Num() * sizeof(BoneTrackPair)) == 0;
+	};
+
+	return IsSame(RotationPairs, RotationPairs_) && IsSame(TranslationPairs, TranslationPairs_) && IsSame(ScalePairs, ScalePairs_);
+}
+
+FACLPoseCacheKey FACLPoseCache::MakeKey(const FACLCompressedAnimData& AnimData, const FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, float& OutSampleTime)
+{
+	const float TimeQuantum = FMath::Max(GACLPoseCacheTimeQuantum, KINDA_SMALL_NUMBER);
+	const int32 QuantizedSample = FMath::RoundToInt(DecompContext.Time / TimeQuantum);
+
+	OutSampleTime = FMath::Clamp(float(QuantizedSample) * TimeQuantum, 0.0f, DecompContext.SequenceLength);
+
+	// Instances with different LODs, bone masks, or decompression qualities decode different poses
+	uint32 BoneSetHash = FCrc::MemCrc32(RotationPairs.GetData(), RotationPairs.Num() * sizeof(BoneTrackPair));
+	BoneSetHash = FCrc::MemCrc32(TranslationPairs.GetData(), TranslationPairs.Num() * sizeof(BoneTrackPair), BoneSetHash);
+	BoneSetHash = FCrc::MemCrc32(ScalePairs.GetData(), ScalePairs.Num() * sizeof(BoneTrackPair), BoneSetHash);
+	BoneSetHash = HashCombine(BoneSetHash, uint32(DecompContext.Interpolation));
+	BoneSetHash = HashCombine(BoneSetHash, uint32(FACLScopedDecompressionQuality::GetCurrent()));
+
+	return FACLPoseCacheKey{ AnimData.BindId, QuantizedSample, BoneSetHash };
+}
+
+bool FACLPoseCache::Find(const FACLPoseCacheKey& Key, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+{
+	FShard& Shard = GetShard(Key);
+
+	FCachedPosePtr CachedPose;
+	{
+		FScopeLock ScopeLock(&Shard.Lock);
+
+		const FCachedPosePtr* Entry = Shard.Cache.FindAndTouch(Key);
+		if (Entry == nullptr || !(*Entry)->HasTracks(RotationPairs, TranslationPairs, ScalePairs))
+		{
+			// A different set of tracks with the same hash is treated as a miss, it is never written over our output
+			Shard.Stats.NumMisses++;
+			return false;
+		}
+
+		Shard.Stats.NumHits++;
+		CachedPose = *Entry;
+	}
+
+	// Cached poses are immutable, we can copy outside of the lock
+	for (int32 PairIndex = 0; PairIndex < RotationPairs.Num(); ++PairIndex)
+	{
+		OutAtoms[RotationPairs[PairIndex].AtomIndex].SetRotation(CachedPose->Rotations[PairIndex]);
+	}
+
+	for (int32 PairIndex = 0; PairIndex < TranslationPairs.Num(); ++PairIndex)
+	{
+		OutAtoms[TranslationPairs[PairIndex].AtomIndex].SetTranslation(CachedPose->Translations[PairIndex]);
+	}
+
+	// Scale is only present if the sequence has scale
+	for (int32 PairIndex = 0; PairIndex < CachedPose->Scales.Num(); ++PairIndex)
+	{
+		OutAtoms[ScalePairs[PairIndex].AtomIndex].SetScale3D(CachedPose->Scales[PairIndex]);
+	}
+
+	return true;
+}
+
+void FACLPoseCache::Add(const FACLPoseCacheKey& Key, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, const TArrayView<FTransform>& Atoms, bool bHasScale)
+{
+	TSharedRef<FCachedPose, ESPMode::ThreadSafe> CachedPose = MakeShared<FCachedPose, ESPMode::ThreadSafe>();
+	CachedPose->RotationPairs = RotationPairs;
+	CachedPose->TranslationPairs = TranslationPairs;
+	CachedPose->ScalePairs = ScalePairs;
+
+	CachedPose->Rotations.Reserve(RotationPairs.Num());
+	for (const BoneTrackPair& Pair : RotationPairs)
+	{
+		CachedPose->Rotations.Add(Atoms[Pair.AtomIndex].GetRotation());
+	}
+
+	CachedPose->Translations.Reserve(TranslationPairs.Num());
+	for (const BoneTrackPair& Pair : TranslationPairs)
+	{
+		CachedPose->Translations.Add(Atoms[Pair.AtomIndex].GetTranslation());
+	}
+
+	if (bHasScale)
+	{
+		CachedPose->Scales.Reserve(ScalePairs.Num());
+		for (const BoneTrackPair& Pair : ScalePairs)
+		{
+			CachedPose->Scales.Add(Atoms[Pair.AtomIndex].GetScale3D());
+		}
+	}
+
+	const SIZE_T PoseSize = CachedPose->GetAllocatedSize();
+	const SIZE_T MemoryBudget = GetMemoryBudget() / NumShards;
+
+	FShard& Shard = GetShard(Key);
+	FScopeLock ScopeLock(&Shard.Lock);
+
+	if (Shard.Cache.Contains(Key))
+	{
+		return;	// Another thread decompressed the same pose concurrently
+	}
+
+	while (Shard.Cache.Num() != 0 && (Shard.Stats.UsedMemory + PoseSize > MemoryBudget || Shard.Cache.Num() >= Shard.Cache.Max()))
+	{
+		Shard.EvictLeastRecent();
+	}
+
+	if (PoseSize > MemoryBudget)
+	{
+		return;	// Doesn't fit at all
+	}
+
+	Shard.Cache.Add(Key, CachedPose);
+	Shard.Stats.UsedMemory += PoseSize;
+}
+
+void FACLPoseCache::FShard::EvictLeastRecent()
+{
+	const FCachedPosePtr EvictedPose = Cache.RemoveLeastRecent();
+	if (EvictedPose.IsValid())
+	{
+		Stats.UsedMemory -= EvictedPose->GetAllocatedSize();
+	}
+
+	Stats.NumEvictions++;
+}
+
+FACLPoseCacheStats FACLPoseCache::GetStats() const
+{
+	FACLPoseCacheStats Result;
+	for (const FShard& Shard : Shards)
+	{
+		FScopeLock ScopeLock(&Shard.Lock);
+
+		Result.NumHits += Shard.Stats.NumHits;
+		Result.NumMisses += Shard.Stats.NumMisses;
+		Result.NumEvictions += Shard.Stats.NumEvictions;
+		Result.NumEntries += Shard.Cache.Num();
+		Result.UsedMemory += Shard.Stats.UsedMemory;
+	}
+
+	Result.MemoryBudget = GetMemoryBudget();
+	return Result;
+}
+
+void FACLPoseCache::Reset()
+{
+	for (FShard& Shard : Shards)
+	{
+		FScopeLock ScopeLock(&Shard.Lock);
+
+		Shard.Cache.Empty(MaxNumCachedPoses / NumShards);
+		Shard.Stats = FACLPoseCacheStats();
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "AnimEncoding.h"
+#include "Containers/LruCache.h"
+#include "HAL/CriticalSection.h"
+
+struct FACLCompressedAnimData;
+
+/** Whether decompressed poses are cached, controlled with the ACL.PoseCache.Enable console variable. */
+extern int32 GACLPoseCacheEnabled;
+
+/** The key of a decompressed pose: the bound compressed data, the quantized sample time, and the requested tracks. */
+struct FACLPoseCacheKey
+{
+	uint32 BindId;
+	int32 QuantizedSample;
+	uint32 BoneSetHash;
+
+	bool operator==(const FACLPoseCacheKey& Other) const
+	{
+		return BindId == Other.BindId && QuantizedSample == Other.QuantizedSample && BoneSetHash == Other.BoneSetHash;
+	}
+
+	friend uint32 GetTypeHash(const FACLPoseCacheKey& Key)
+	{
+		return HashCombine(HashCombine(Key.BindId, GetTypeHash(Key.QuantizedSample)), Key.BoneSetHash);
+	}
+};
+
+struct FACLPoseCacheStats
+{
+	int64 NumHits = 0;
+	int64 NumMisses = 0;
+	int64 NumEvictions = 0;
+	int32 NumEntries = 0;
+	SIZE_T UsedMemory = 0;
+	SIZE_T MemoryBudget = 0;
+};
+
+/*
+ * An LRU cache of decompressed local space poses shared by every instance that samples the same
+ * anim sequence at nearly the same time. Sample times are snapped to a configurable time quantum
+ * and poses are evicted once the memory budget is exceeded. The cache is opt-in since snapping
+ * changes the sampled pose slightly and it only pays off when many instances play the same sequences.
+ */
+class FACLPoseCache
+{
+public:
+	static FACLPoseCache& Get();
+
+	/** Builds the cache key of a pose and returns the quantized time the pose should be decompressed at. */
+	static FACLPoseCacheKey MakeKey(const FACLCompressedAnimData& AnimData, const FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, float& OutSampleTime);
+
+	/** Writes the cached pose in the output atoms if it is present. */
+	bool Find(const FACLPoseCacheKey& Key, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms);
+
+	/** Caches a freshly decompressed pose, evicting the least recently used poses to remain within the memory budget. */
+	void Add(const FACLPoseCacheKey& Key, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, const TArrayView<FTransform>& Atoms, bool bHasScale);
+
+	FACLPoseCacheStats GetStats() const;
+
+	/** Removes every cached pose and resets the statistics. */
+	void Reset();
+
+private:
+	FACLPoseCache() = default;
+
+	struct FCachedPose
+	{
+		/** The requested tracks, the bone set hash can collide and hits must match them. */
+		TArray<BoneTrackPair> RotationPairs;
+		TArray<BoneTrackPair> TranslationPairs;
+		TArray<BoneTrackPair> ScalePairs;
+
+		TArray<FQuat> Rotations;
+		TArray<FVector> Translations;
+		TArray<FVector> Scales;
+
+		bool HasTracks(const BoneTrackArray& RotationPairs_, const BoneTrackArray& TranslationPairs_, const BoneTrackArray& ScalePairs_) const;
+
+		SIZE_T GetAllocatedSize() const
+		{
+			return sizeof(FCachedPose) + RotationPairs.GetAllocatedSize() + TranslationPairs.GetAllocatedSize() + ScalePairs.GetAllocatedSize()
+				+ Rotations.GetAllocatedSize() + Translations.GetAllocatedSize() + Scales.GetAllocatedSize();
+		}
+	};
+
+	using FCachedPosePtr = TSharedPtr<const FCachedPose, ESPMode::ThreadSafe>;
+
+	/** Poses are split between shards by key hash so that concurrent lookups rarely contend on the same lock. */
+	static constexpr int32 NumShards = 16;
+
+	struct FShard
+	{
+		FShard();
+
+		void EvictLeastRecent();
+
+		mutable FCriticalSection Lock;
+		TLruCache<FACLPoseCacheKey, FCachedPosePtr> Cache;
+		FACLPoseCacheStats Stats;
+	};
+
+	FShard& GetShard(const FACLPoseCacheKey& Key) { return Shards[GetTypeHash(Key) % NumShards]; }
+
+	FShard Shards[NumShards];
+};
@@ -3,8 +3,14 @@
 #include "ACLStatsDumpCommandlet.h"
 
 #if WITH_EDITOR
+#include "Runtime/Core/Public/Async/MappedFileHandle.h"
+#include "Runtime/Core/Public/Async/ParallelFor.h"
 #include "Runtime/Core/Public/HAL/FileManagerGeneric.h"
+#include "Runtime/Core/Public/HAL/PlatformFilemanager.h"
 #include "Runtime/Core/Public/HAL/PlatformTime.h"
+#include "Runtime/Core/Public/Misc/Compression.h"
+#include "Runtime/Core/Public/Serialization/MemoryReader.h"
+#include "Runtime/Core/Public/Serialization/MemoryWriter.h"
 #include "Runtime/CoreUObject/Public/UObject/UObjectIterator.h"
 #include "Runtime/Engine/Classes/Animation/AnimBoneCompressionSettings.h"
 #include "Runtime/Engine/Classes/Animation/AnimCompress.h"
@@ -14,11 +20,14 @@
 #include "Editor/UnrealEd/Public/PackageHelperFunctions.h"
 
 #include "AnimBoneCompressionCodec_ACL.h"
+#include "AnimCurveCompressionCodec_ACLCustom.h"
+#include "ACLDecompressionImpl.h"
 #include "ACLImpl.h"
 
 #include <sjson/parser.h>
 #include <sjson/writer.h>
 
+#include <acl/compression/compress.h>
 #include <acl/compression/impl/track_list_context.h>	// For create_output_track_mapping(..)
 #include <acl/compression/track_array.h>
 #include <acl/compression/transform_error_metrics.h>
@@ -43,57 +52,175 @@
 //		-noerror: Disables the exhaustive error dumping
 //		-noauto: Disables automatic compression
 //		-noacl: Disables ACL compression
+//		-loadbench: Measures how long it takes to load the ACL compressed data of each sequence
+//		-decompbench: Measures how long it takes to decompress a pose with every codec tried with sequential, random, and cold cache access patterns
+//		-sweep: Compresses the input clips with a grid of ACL settings and outputs the size, error, and timings of each along with the Pareto front
+//		-SweepErrorThresholds=<thresholds>: Comma separated list of error thresholds used by the sweep (default: 0.001,0.01,0.1)
+//		-SweepVirtualVertexDistances=<distances>: Comma separated list of default virtual vertex distances used by the sweep (default: 1,3,10)
+//			Every track keeps its distance relative to the codec default, e.g. bones with the safe distance scale along
+//		-curves: Compresses the curves with every ACL compression level and outputs their size and decompression time
 //		-MasterTolerance=<tolerance>: The error threshold used by automatic compression
+//		-gzip: The stats are written as gzip compressed *_stats.sjson.gz files
+//		-binary: The exhaustive error is written in compact binary *_error.bin files instead of in the stats
 //		-resume: If present, clip extraction or compression will continue where it left off
 //////////////////////////////////////////////////////////////////////////
 
+/*
+ * The SJSON writer performs a very large number of tiny writes, we buffer them in a large block
+ * that is flushed in bulk to the file. Each block can optionally be written as a gzip member, the
+ * resulting file is a valid multi-member gzip file. If a block fails to compress, nothing more is written
+ * and Close reports the failure since the output would be truncated.
+ */
 class UE4SJSONStreamWriter final : public sjson::StreamWriter
 {
 public:
-	UE4SJSONStreamWriter(FArchive* File_)
+	UE4SJSONStreamWriter(FArchive* File_, bool bCompress_)
 		: File(File_)
-	{}
+		, bCompress(bCompress_)
+	{
+		Buffer.Reserve(BlockSize);
+	}
 
-	virtual void write(const void* Buffer, size_t BufferSize) override
+	virtual void write(const void* Data, size_t DataSize) override
 	{
-		File->Serialize(const_cast<void*>(Buffer), BufferSize);
+		if (bFailed)
+		{
+			return;
+		}
+
+		const uint8* DataPtr = static_cast<const uint8*>(Data);
+		while (DataSize != 0)
+		{
+			// Clamp before narrowing, a single write can be larger than what an int32 holds
+			const int32 NumToCopy = int32(FMath::Min<SIZE_T>(SIZE_T(BlockSize - Buffer.Num()), DataSize));
+			Buffer.Append(DataPtr, NumToCopy);
+
+			DataPtr += NumToCopy;
+			DataSize -= NumToCopy;
+
+			if (Buffer.Num() == BlockSize)
+			{
+				Flush();
+
+				if (bFailed)
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	void Flush()
+	{
+		if (Buffer.Num() == 0)
+		{
+			return;
+		}
+
+		if (bCompress)
+		{
+			int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Gzip, Buffer.Num());
+			CompressedBuffer.SetNumUninitialized(CompressedSize, false);
+
+			if (FCompression::CompressMemory(NAME_Gzip, CompressedBuffer.GetData(), CompressedSize, Buffer.GetData(), Buffer.Num()))
+			{
+				File->Serialize(CompressedBuffer.GetData(), CompressedSize);
+			}
+			else
+			{
+				UE_LOG(LogAnimationCompression, Error, TEXT("Failed to compress the stats output"));
+				bFailed = true;
+			}
+		}
+		else
+		{
+			File->Serialize(Buffer.GetData(), Buffer.Num());
+		}
+
+		Buffer.Reset();
+	}
+
+	/** Flushes the pending data and closes the file, returns false if the output is incomplete. */
+	bool Close()
+	{
+		if (!bFailed)
+		{
+			Flush();
+		}
+
+		const bool bClosed = File->Close();
+		return bClosed && !bFailed;
 	}
 
 private:
+	static constexpr int32 BlockSize = 4 * 1024 * 1024;
+
 	FArchive* File;
+	bool bCompress;
+	bool bFailed = false;
+
+	TArray<uint8> Buffer;
+	TArray<uint8> CompressedBuffer;
 };
 
-static const TCHAR* ReadACLClip(FFileManagerGeneric& FileManager, const FString& ACLClipPath, acl::iallocator& Allocator, acl::track_array_qvvf& OutTracks)
+static const TCHAR* ParseACLClip(const char* RawSJSONData, int64 Size, acl::iallocator& Allocator, acl::track_array_qvvf& OutTracks)
 {
-	FArchive* Reader = FileManager.CreateFileReader(*ACLClipPath);
-	const int64 Size = Reader->TotalSize();
-
-	// Allocate directly without a TArray to automatically manage the memory because some
-	// clips are larger than 2 GB
-	char* RawSJSONData = static_cast<char*>(GMalloc->Malloc(Size));
-
-	Reader->Serialize(RawSJSONData, Size);
-	Reader->Close();
-
 	acl::clip_reader ClipReader(Allocator, RawSJSONData, Size);
 
 	if (ClipReader.get_file_type() != acl::sjson_file_type::raw_clip)
 	{
-		GMalloc->Free(RawSJSONData);
 		return TEXT("SJSON file isn't a raw clip");
 	}
 
 	acl::sjson_raw_clip RawClip;
 	if (!ClipReader.read_raw_clip(RawClip))
 	{
-		GMalloc->Free(RawSJSONData);
 		return TEXT("Failed to read ACL raw clip from file");
 	}
 
 	OutTracks = MoveTemp(RawClip.track_list);
+	return nullptr;
+}
+
+static const TCHAR* ReadACLClip(FFileManagerGeneric& FileManager, const FString& ACLClipPath, acl::iallocator& Allocator, acl::track_array_qvvf& OutTracks)
+{
+	// Memory map the clip when we can, the parser reads it in place and the OS pages it in as needed
+	// which keeps our peak memory usage low even for clips larger than 2 GB
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*ACLClipPath));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile.IsValid() ? MappedFile->MapRegion() : nullptr);
+	if (MappedRegion.IsValid())
+	{
+		const char* RawSJSONData = reinterpret_cast<const char*>(MappedRegion->GetMappedPtr());
+		const int64 Size = MappedRegion->GetMappedSize();
+
+		// The region must be released before the file handle
+		const TCHAR* ErrorMsg = ParseACLClip(RawSJSONData, Size, Allocator, OutTracks);
+		MappedRegion.Reset();
+		return ErrorMsg;
+	}
+
+	// Fallback to reading the whole file if memory mapping isn't supported
+	FArchive* Reader = FileManager.CreateFileReader(*ACLClipPath);
+	if (Reader == nullptr)
+	{
+		return TEXT("Failed to open ACL raw clip file");
+	}
+
+	const int64 Size = Reader->TotalSize();
+
+	// Allocate directly without a TArray to automatically manage the memory because some
+	// clips are larger than 2 GB
+	char* RawSJSONData = static_cast<char*>(GMalloc->Malloc(Size));
+
+	Reader->Serialize(RawSJSONData, Size);
+	Reader->Close();
+	delete Reader;
+
+	const TCHAR* ErrorMsg = ParseACLClip(RawSJSONData, Size, Allocator, OutTracks);
 
 	GMalloc->Free(RawSJSONData);
-	return nullptr;
+	return ErrorMsg;
 }
 
 static void ConvertSkeleton(const acl::track_array_qvvf& Tracks, USkeleton* UE4Skeleton)
@@ -258,6 +385,145 @@ struct SimpleTransformWriter final : public acl::track_writer
 	}
 };
 
+// Number of samples each task evaluates when calculating the error in parallel
+static constexpr uint32 NumErrorSamplesPerTask = 16;
+
+static void CalculateClipDetailedError(const acl::track_array_qvvf& Tracks, const UAnimSequence* UE4Clip, USkeleton* UE4Skeleton, TArray<float>& OutErrors)
+{
+	const uint32 NumBones = Tracks.get_num_tracks();
+	const float ClipDuration = Tracks.get_duration();
+	const float SampleRate = Tracks.get_sample_rate();
+	const uint32 NumSamples = Tracks.get_num_samples_per_track();
+	const bool HasScale = UE4ClipHasScale(UE4Clip);
+
+	// Errors are stored per frame, then per bone
+	OutErrors.SetNumUninitialized(NumSamples * NumBones);
+
+	const acl::qvvf_transform_error_metric ErrorMetric;
+
+	TArray<uint32> ParentTransformIndices;
+	TArray<uint32> SelfTransformIndices;
+	ParentTransformIndices.AddUninitialized(NumBones);
+	SelfTransformIndices.AddUninitialized(NumBones);
+
+	for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		const acl::track_qvvf& Track = Tracks[BoneIndex];
+		const acl::track_desc_transformf& Desc = Track.get_description();
+
+		ParentTransformIndices[BoneIndex] = Desc.parent_index;
+		SelfTransformIndices[BoneIndex] = BoneIndex;
+	}
+
+	// Use the ACL code if we can to calculate the error instead of approximating it with UE4.
+	const UAnimBoneCompressionCodec_ACLBase* ACLCodec = Cast<UAnimBoneCompressionCodec_ACLBase>(UE4Clip->CompressedData.BoneCompressionCodec);
+	const acl::compressed_tracks* CompressedClipData = ACLCodec != nullptr ? acl::make_compressed_tracks(UE4Clip->CompressedData.CompressedByteStream.GetData()) : nullptr;
+
+	ACLAllocator Allocator;
+	uint32 NumOutputBones = 0;
+	uint32* OutputBoneMapping = CompressedClipData != nullptr ? acl::acl_impl::create_output_track_mapping(Allocator, Tracks, NumOutputBones) : nullptr;
+
+	// Every task evaluates a contiguous range of samples with its own pose buffers and decompression context
+	// and writes to its own portion of the output, the result is identical to evaluating the samples in order
+	const int32 NumTasks = (NumSamples + NumErrorSamplesPerTask - 1) / NumErrorSamplesPerTask;
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		TArray<rtm::qvvf> RawLocalPoseTransforms;
+		TArray<rtm::qvvf> RawObjectPoseTransforms;
+		TArray<rtm::qvvf> LossyLocalPoseTransforms;
+		TArray<rtm::qvvf> LossyRemappedLocalPoseTransforms;
+		TArray<rtm::qvvf> LossyObjectPoseTransforms;
+		RawLocalPoseTransforms.AddUninitialized(NumBones);
+		RawObjectPoseTransforms.AddUninitialized(NumBones);
+		LossyLocalPoseTransforms.AddUninitialized(NumBones);
+		LossyObjectPoseTransforms.AddUninitialized(NumBones);
+
+		SimpleTransformWriter RawWriter(RawLocalPoseTransforms);
+		SimpleTransformWriter PoseWriter(LossyLocalPoseTransforms);
+
+		acl::itransform_error_metric::local_to_object_space_args local_to_object_space_args_raw;
+		local_to_object_space_args_raw.dirty_transform_indices = SelfTransformIndices.GetData();
+		local_to_object_space_args_raw.num_dirty_transforms = NumBones;
+		local_to_object_space_args_raw.parent_transform_indices = ParentTransformIndices.GetData();
+		local_to_object_space_args_raw.local_transforms = RawLocalPoseTransforms.GetData();
+		local_to_object_space_args_raw.num_transforms = NumBones;
+
+		acl::itransform_error_metric::local_to_object_space_args local_to_object_space_args_lossy = local_to_object_space_args_raw;
+		local_to_object_space_args_lossy.local_transforms = LossyLocalPoseTransforms.GetData();
+
+		acl::decompression_context<acl::debug_transform_decompression_settings> Context;
+		if (CompressedClipData != nullptr)
+		{
+			Context.initialize(*CompressedClipData);
+
+			LossyRemappedLocalPoseTransforms.AddUninitialized(NumBones);
+			local_to_object_space_args_lossy.local_transforms = LossyRemappedLocalPoseTransforms.GetData();
+		}
+
+		const uint32 FirstSampleIndex = TaskIndex * NumErrorSamplesPerTask;
+		const uint32 LastSampleIndex = FMath::Min(FirstSampleIndex + NumErrorSamplesPerTask, NumSamples);
+		for (uint32 SampleIndex = FirstSampleIndex; SampleIndex < LastSampleIndex; ++SampleIndex)
+		{
+			// Sample our streams and calculate the error
+			const float SampleTime = rtm::scalar_min(float(SampleIndex) / SampleRate, ClipDuration);
+
+			Tracks.sample_tracks(SampleTime, acl::sample_rounding_policy::none, RawWriter);
+
+			if (CompressedClipData != nullptr)
+			{
+				Context.seek(SampleTime, acl::sample_rounding_policy::none);
+				Context.decompress_tracks(PoseWriter);
+
+				// Perform remapping by copying the raw pose first and we overwrite with the decompressed pose if
+				// the data is available
+				LossyRemappedLocalPoseTransforms = RawLocalPoseTransforms;
+				for (uint32 OutputIndex = 0; OutputIndex < NumOutputBones; ++OutputIndex)
+				{
+					const uint32 BoneIndex = OutputBoneMapping[OutputIndex];
+					LossyRemappedLocalPoseTransforms[BoneIndex] = LossyLocalPoseTransforms[OutputIndex];
+				}
+			}
+			else
+			{
+				SampleUE4Clip(Tracks, UE4Skeleton, UE4Clip, SampleTime, LossyLocalPoseTransforms.GetData());
+			}
+
+			if (HasScale)
+			{
+				ErrorMetric.local_to_object_space(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
+				ErrorMetric.local_to_object_space(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
+			}
+			else
+			{
+				ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
+				ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
+			}
+
+			float* PoseErrors = OutErrors.GetData() + (SampleIndex * NumBones);
+			for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+			{
+				const acl::track_qvvf& Track = Tracks[BoneIndex];
+				const acl::track_desc_transformf& Desc = Track.get_description();
+
+				acl::itransform_error_metric::calculate_error_args calculate_error_args;
+				calculate_error_args.transform0 = &RawObjectPoseTransforms[BoneIndex];
+				calculate_error_args.transform1 = &LossyObjectPoseTransforms[BoneIndex];
+				calculate_error_args.construct_sphere_shell(Desc.shell_distance);
+
+				if (HasScale)
+					PoseErrors[BoneIndex] = rtm::scalar_cast(ErrorMetric.calculate_error(calculate_error_args));
+				else
+					PoseErrors[BoneIndex] = rtm::scalar_cast(ErrorMetric.calculate_error_no_scale(calculate_error_args));
+			}
+		}
+	});
+
+	if (OutputBoneMapping != nullptr)
+	{
+		acl::deallocate_type_array(Allocator, OutputBoneMapping, NumOutputBones);
+	}
+}
+
 static void CalculateClipError(const acl::track_array_qvvf& Tracks, const UAnimSequence* UE4Clip, USkeleton* UE4Skeleton, uint32& OutWorstBone, float& OutMaxError, float& OutWorstSampleTime)
 {
 	// Use the ACL code if we can to calculate the error instead of approximating it with UE4.
@@ -283,299 +549,434 @@ static void CalculateClipError(const acl::track_array_qvvf& Tracks, const UAnimS
 	const float ClipDuration = Tracks.get_duration();
 	const float SampleRate = Tracks.get_sample_rate();
 	const uint32 NumSamples = Tracks.get_num_samples_per_track();
-	const bool HasScale = UE4ClipHasScale(UE4Clip);
 
-	TArray<rtm::qvvf> RawLocalPoseTransforms;
-	TArray<rtm::qvvf> RawObjectPoseTransforms;
-	TArray<rtm::qvvf> LossyLocalPoseTransforms;
-	TArray<rtm::qvvf> LossyObjectPoseTransforms;
-	RawLocalPoseTransforms.AddUninitialized(NumBones);
-	RawObjectPoseTransforms.AddUninitialized(NumBones);
-	LossyLocalPoseTransforms.AddUninitialized(NumBones);
-	LossyObjectPoseTransforms.AddUninitialized(NumBones);
+	// The samples are evaluated in parallel, we then reduce in order to find the earliest worst bone
+	TArray<float> Errors;
+	CalculateClipDetailedError(Tracks, UE4Clip, UE4Skeleton, Errors);
 
 	uint32 WorstBone = acl::k_invalid_track_index;
 	float MaxError = 0.0f;
 	float WorstSampleTime = 0.0f;
 
-	const acl::qvvf_transform_error_metric ErrorMetric;
-	SimpleTransformWriter RawWriter(RawLocalPoseTransforms);
+	for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		const float* PoseErrors = Errors.GetData() + (SampleIndex * NumBones);
+		for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+		{
+			const float Error = PoseErrors[BoneIndex];
+			if (Error > MaxError)
+			{
+				MaxError = Error;
+				WorstBone = BoneIndex;
+				WorstSampleTime = rtm::scalar_min(float(SampleIndex) / SampleRate, ClipDuration);
+			}
+		}
+	}
 
-	TArray<uint32> ParentTransformIndices;
-	TArray<uint32> SelfTransformIndices;
-	ParentTransformIndices.AddUninitialized(NumBones);
-	SelfTransformIndices.AddUninitialized(NumBones);
+	OutWorstBone = WorstBone;
+	OutMaxError = MaxError;
+	OutWorstSampleTime = WorstSampleTime;
+}
 
-	for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+/*
+ * Writes the detailed per frame and per bone errors in a compact binary format that can be memory mapped.
+ * All values are little endian:
+ *   Header: uint32 tag ('ACLE'), uint32 version, uint32 number of sections, uint32 padding
+ *   Section headers: char name[32], uint32 number of samples, uint32 number of bones, uint64 offset of the section data
+ *   Section data: float32 errors[number of samples][number of bones], 16 byte aligned
+ */
+class FACLBinaryErrorStatsWriter
+{
+public:
+	static constexpr uint32 Tag = 0x454C4341;	// 'ACLE'
+	static constexpr uint32 Version = 1;
+
+	void AddSection(const char* Name, uint32 NumSamples, uint32 NumBones, TArray<float>&& Errors)
 	{
-		const acl::track_qvvf& Track = Tracks[BoneIndex];
-		const acl::track_desc_transformf& Desc = Track.get_description();
+		check(Errors.Num() == NumSamples * NumBones);
 
-		ParentTransformIndices[BoneIndex] = Desc.parent_index;
-		SelfTransformIndices[BoneIndex] = BoneIndex;
+		FSection& Section = Sections.AddDefaulted_GetRef();
+		FCStringAnsi::Strncpy(Section.Name, Name, sizeof(Section.Name));
+		Section.NumSamples = NumSamples;
+		Section.NumBones = NumBones;
+		Section.Errors = MoveTemp(Errors);
 	}
 
-	acl::itransform_error_metric::local_to_object_space_args local_to_object_space_args_raw;
-	local_to_object_space_args_raw.dirty_transform_indices = SelfTransformIndices.GetData();
-	local_to_object_space_args_raw.num_dirty_transforms = NumBones;
-	local_to_object_space_args_raw.parent_transform_indices = ParentTransformIndices.GetData();
-	local_to_object_space_args_raw.local_transforms = RawLocalPoseTransforms.GetData();
-	local_to_object_space_args_raw.num_transforms = NumBones;
+	bool IsEmpty() const { return Sections.Num() == 0; }
 
-	acl::itransform_error_metric::local_to_object_space_args local_to_object_space_args_lossy = local_to_object_space_args_raw;
-	local_to_object_space_args_lossy.local_transforms = LossyLocalPoseTransforms.GetData();
-
-	for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	/** Writes the error file, returns false and deletes any partial output if it couldn't be written entirely. */
+	bool Save(FFileManagerGeneric& FileManager, const FString& Path) const
 	{
-		// Sample our streams and calculate the error
-		const float SampleTime = rtm::scalar_min(float(SampleIndex) / SampleRate, ClipDuration);
+		FArchive* File = FileManager.CreateFileWriter(*Path);
+		if (File == nullptr)
+		{
+			return false;
+		}
+
+		uint32 HeaderTag = Tag;
+		uint32 HeaderVersion = Version;
+		uint32 NumSections = Sections.Num();
+		uint32 Padding = 0;
+		*File << HeaderTag << HeaderVersion << NumSections << Padding;
 
-		Tracks.sample_tracks(SampleTime, acl::sample_rounding_policy::none, RawWriter);
-		SampleUE4Clip(Tracks, UE4Skeleton, UE4Clip, SampleTime, LossyLocalPoseTransforms.GetData());
+		const uint64 SectionHeaderSize = sizeof(FSection::Name) + sizeof(uint32) * 2 + sizeof(uint64);
+		uint64 DataOffset = Align(sizeof(uint32) * 4 + SectionHeaderSize * NumSections, 16);
 
-		if (HasScale)
+		for (const FSection& Section : Sections)
 		{
-			ErrorMetric.local_to_object_space(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
-			ErrorMetric.local_to_object_space(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
+			uint32 NumSamples = Section.NumSamples;
+			uint32 NumBones = Section.NumBones;
+			uint64 Offset = DataOffset;
+
+			File->Serialize(const_cast<ANSICHAR*>(Section.Name), sizeof(Section.Name));
+			*File << NumSamples << NumBones << Offset;
+
+			DataOffset = Align(DataOffset + Section.Errors.Num() * sizeof(float), 16);
 		}
-		else
+
+		for (const FSection& Section : Sections)
 		{
-			ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
-			ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
+			WritePadding(*File);
+			File->Serialize(const_cast<float*>(Section.Errors.GetData()), Section.Errors.Num() * sizeof(float));
 		}
 
-		for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
-		{
-			const acl::track_qvvf& Track = Tracks[BoneIndex];
-			const acl::track_desc_transformf& Desc = Track.get_description();
+		const bool bSuccess = File->Close();
+		delete File;
 
-			acl::itransform_error_metric::calculate_error_args calculate_error_args;
-			calculate_error_args.transform0 = &RawObjectPoseTransforms[BoneIndex];
-			calculate_error_args.transform1 = &LossyObjectPoseTransforms[BoneIndex];
-			calculate_error_args.construct_sphere_shell(Desc.shell_distance);
+		if (!bSuccess)
+		{
+			FileManager.Delete(*Path);
+		}
 
-			float Error;
-			if (HasScale)
-				Error = rtm::scalar_cast(ErrorMetric.calculate_error(calculate_error_args));
-			else
-				Error = rtm::scalar_cast(ErrorMetric.calculate_error_no_scale(calculate_error_args));
+		return bSuccess;
+	}
 
-			if (Error > MaxError)
-			{
-				MaxError = Error;
-				WorstBone = BoneIndex;
-				WorstSampleTime = SampleTime;
-			}
+private:
+	static void WritePadding(FArchive& File)
+	{
+		uint8 Zero = 0;
+		while (!IsAligned(File.Tell(), 16))
+		{
+			File << Zero;
 		}
 	}
 
-	OutWorstBone = WorstBone;
-	OutMaxError = MaxError;
-	OutWorstSampleTime = WorstSampleTime;
-}
+	struct FSection
+	{
+		ANSICHAR Name[32];
+		uint32 NumSamples;
+		uint32 NumBones;
+		TArray<float> Errors;
+	};
+
+	TArray<FSection> Sections;
+};
 
-static void DumpClipDetailedError(const acl::track_array_qvvf& Tracks, UAnimSequence* UE4Clip, USkeleton* UE4Skeleton, sjson::ObjectWriter& Writer)
+static void DumpClipDetailedError(const acl::track_array_qvvf& Tracks, UAnimSequence* UE4Clip, USkeleton* UE4Skeleton, const char* SectionName, FACLBinaryErrorStatsWriter* BinaryErrorStats, sjson::ObjectWriter& Writer)
 {
 	const uint32 NumBones = Tracks.get_num_tracks();
-	const float ClipDuration = Tracks.get_duration();
-	const float SampleRate = Tracks.get_sample_rate();
 	const uint32 NumSamples = Tracks.get_num_samples_per_track();
-	const bool HasScale = UE4ClipHasScale(UE4Clip);
 
-	TArray<rtm::qvvf> RawLocalPoseTransforms;
-	TArray<rtm::qvvf> RawObjectPoseTransforms;
-	TArray<rtm::qvvf> LossyLocalPoseTransforms;
-	TArray<rtm::qvvf> LossyObjectPoseTransforms;
-	RawLocalPoseTransforms.AddUninitialized(NumBones);
-	RawObjectPoseTransforms.AddUninitialized(NumBones);
-	LossyLocalPoseTransforms.AddUninitialized(NumBones);
-	LossyObjectPoseTransforms.AddUninitialized(NumBones);
+	TArray<float> Errors;
+	CalculateClipDetailedError(Tracks, UE4Clip, UE4Skeleton, Errors);
 
-	const acl::qvvf_transform_error_metric ErrorMetric;
+	if (BinaryErrorStats != nullptr)
+	{
+		// The errors are written in the binary file instead which is much faster to parse
+		BinaryErrorStats->AddSection(SectionName, NumSamples, NumBones, MoveTemp(Errors));
+		return;
+	}
 
-	SimpleTransformWriter RawWriter(RawLocalPoseTransforms);
+	Writer["error_per_frame_and_bone"] = [&](sjson::ArrayWriter& Writer)
+	{
+		for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+		{
+			const float* PoseErrors = Errors.GetData() + (SampleIndex * NumBones);
 
-	TArray<uint32> ParentTransformIndices;
-	TArray<uint32> SelfTransformIndices;
-	ParentTransformIndices.AddUninitialized(NumBones);
-	SelfTransformIndices.AddUninitialized(NumBones);
+			Writer.push_newline();
+			Writer.push([&](sjson::ArrayWriter& Writer)
+				{
+					for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+					{
+						Writer.push(PoseErrors[BoneIndex]);
+					}
+				});
+		}
+	};
+}
 
-	for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
-	{
-		const acl::track_qvvf& Track = Tracks[BoneIndex];
-		const acl::track_desc_transformf& Desc = Track.get_description();
+struct FCompressionContext
+{
+	UAnimBoneCompressionSettings* AutoCompressor;
+	UAnimBoneCompressionSettings* ACLCompressor;
+	UAnimBoneCompressionSettings* KeyReductionCompressor;
 
-		ParentTransformIndices[BoneIndex] = Desc.parent_index;
-		SelfTransformIndices[BoneIndex] = BoneIndex;
+	UAnimSequence* UE4Clip;
+	USkeleton* UE4Skeleton;
+
+	acl::track_array_qvvf ACLTracks;
+
+	uint32 ACLRawSize;
+	int32 UE4RawSize;
+
+	FACLBinaryErrorStatsWriter* BinaryErrorStats = nullptr;
+	bool PerformDecompressionBenchmark = false;
+};
+
+static FString GetCodecName(UAnimBoneCompressionCodec* Codec)
+{
+	if (Codec == nullptr)
+	{
+		return TEXT("<null>");
 	}
 
-	acl::itransform_error_metric::local_to_object_space_args local_to_object_space_args_raw;
-	local_to_object_space_args_raw.dirty_transform_indices = SelfTransformIndices.GetData();
-	local_to_object_space_args_raw.num_dirty_transforms = NumBones;
-	local_to_object_space_args_raw.parent_transform_indices = ParentTransformIndices.GetData();
-	local_to_object_space_args_raw.local_transforms = RawLocalPoseTransforms.GetData();
-	local_to_object_space_args_raw.num_transforms = NumBones;
+	if (Codec->Description.Len() > 0 && Codec->Description != TEXT("None"))
+	{
+		return Codec->Description;
+	}
 
-	acl::itransform_error_metric::local_to_object_space_args local_to_object_space_args_lossy = local_to_object_space_args_raw;
-	local_to_object_space_args_lossy.local_transforms = LossyLocalPoseTransforms.GetData();
+	return Codec->GetClass()->GetName();
+}
 
-	// Use the ACL code if we can to calculate the error instead of approximating it with UE4.
-	UAnimBoneCompressionCodec_ACLBase* ACLCodec = Cast<UAnimBoneCompressionCodec_ACLBase>(UE4Clip->CompressedData.BoneCompressionCodec);
-	if (ACLCodec != nullptr)
+static void DumpACLSizeBreakdown(const FACLCompressedAnimData& AnimData, sjson::ObjectWriter& Writer)
+{
+	if (!AnimData.IsValid())
 	{
-		ACLAllocator Allocator;
+		return;
+	}
 
-		uint32 NumOutputBones = 0;
-		uint32* OutputBoneMapping = acl::acl_impl::create_output_track_mapping(Allocator, Tracks, NumOutputBones);
+	const acl::compressed_tracks* CompressedClipData = acl::make_compressed_tracks(AnimData.CompressedByteStream.GetData());
 
-		TArray<rtm::qvvf> LossyRemappedLocalPoseTransforms;
-		LossyRemappedLocalPoseTransforms.AddUninitialized(NumBones);
+	const acl::acl_impl::transform_tracks_header& TransformHeader = acl::acl_impl::get_transform_tracks_header(*CompressedClipData);
+	const acl::acl_impl::segment_header* SegmentHeaders = TransformHeader.get_segment_headers();
+	const uint32 NumSegments = TransformHeader.num_segments;
 
-		local_to_object_space_args_lossy.local_transforms = LossyRemappedLocalPoseTransforms.GetData();
+	uint64 SegmentHeadersSize = 0;
+	uint64 DefaultTracksSize = 0;
+	uint64 TrackMetadataSize = 0;
+	uint64 ConstantTrackDataSize = 0;
+	uint64 ClipRangeDataSize = 0;
+	uint64 SegmentRangeDataSize = 0;
+	uint64 AnimatedDataSize = 0;
 
-		const acl::compressed_tracks* CompressedClipData = acl::make_compressed_tracks(UE4Clip->CompressedData.CompressedByteStream.GetData());
+	// Every region is sized by where the next one starts, the compressed data layout is tightly packed
+	struct FRegion
+	{
+		const uint8* Start;
+		uint64* Size;
+	};
 
-		acl::decompression_context<acl::debug_transform_decompression_settings> Context;
-		Context.initialize(*CompressedClipData);
+	TArray<FRegion> Regions;
+	if (TransformHeader.segment_start_indices_offset.is_valid())
+	{
+		Regions.Add({ reinterpret_cast<const uint8*>(TransformHeader.get_segment_start_indices()), &SegmentHeadersSize });
+	}
 
-		Writer["error_per_frame_and_bone"] = [&](sjson::ArrayWriter& Writer)
-		{
-			SimpleTransformWriter PoseWriter(LossyLocalPoseTransforms);
+	Regions.Add({ reinterpret_cast<const uint8*>(SegmentHeaders), &SegmentHeadersSize });
+	Regions.Add({ reinterpret_cast<const uint8*>(TransformHeader.get_default_tracks_bitset()), &DefaultTracksSize });
+	Regions.Add({ reinterpret_cast<const uint8*>(TransformHeader.get_constant_tracks_bitset()), &TrackMetadataSize });
+	Regions.Add({ TransformHeader.get_constant_track_data(), &ConstantTrackDataSize });
+	Regions.Add({ TransformHeader.get_clip_range_data(), &ClipRangeDataSize });
 
-			for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
-			{
-				// Sample our streams and calculate the error
-				const float SampleTime = rtm::scalar_min(float(SampleIndex) / SampleRate, ClipDuration);
+	for (uint32 SegmentIndex = 0; SegmentIndex < NumSegments; ++SegmentIndex)
+	{
+		const acl::acl_impl::segment_header& SegmentHeader = SegmentHeaders[SegmentIndex];
+		Regions.Add({ TransformHeader.get_format_per_track_data(SegmentHeader), &TrackMetadataSize });
+		Regions.Add({ TransformHeader.get_segment_range_data(SegmentHeader), &SegmentRangeDataSize });
+		Regions.Add({ TransformHeader.get_track_data(SegmentHeader), &AnimatedDataSize });
+	}
 
-				Tracks.sample_tracks(SampleTime, acl::sample_rounding_policy::none, RawWriter);
+	Regions.Sort([](const FRegion& Lhs, const FRegion& Rhs) { return Lhs.Start < Rhs.Start; });
 
-				Context.seek(SampleTime, acl::sample_rounding_policy::none);
-				Context.decompress_tracks(PoseWriter);
+	const uint8* BufferStart = reinterpret_cast<const uint8*>(CompressedClipData);
+	const uint8* BufferEnd = BufferStart + CompressedClipData->get_size();
 
-				// Perform remapping by copying the raw pose first and we overwrite with the decompressed pose if
-				// the data is available
-				LossyRemappedLocalPoseTransforms = RawLocalPoseTransforms;
-				for (uint32 OutputIndex = 0; OutputIndex < NumOutputBones; ++OutputIndex)
-				{
-					const uint32 BoneIndex = OutputBoneMapping[OutputIndex];
-					LossyRemappedLocalPoseTransforms[BoneIndex] = LossyLocalPoseTransforms[OutputIndex];
-				}
+	// Everything before the first region is the buffer, tracks, and transform headers
+	const uint64 HeaderSize = Regions[0].Start - BufferStart;
 
-				if (HasScale)
-				{
-					ErrorMetric.local_to_object_space(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
-					ErrorMetric.local_to_object_space(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
-				}
-				else
-				{
-					ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
-					ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
-				}
+	for (int32 RegionIndex = 0; RegionIndex < Regions.Num(); ++RegionIndex)
+	{
+		const uint8* RegionEnd = RegionIndex + 1 < Regions.Num() ? Regions[RegionIndex + 1].Start : BufferEnd;
+		*Regions[RegionIndex].Size += RegionEnd - Regions[RegionIndex].Start;
+	}
+
+	Writer["size_breakdown"] = [&](sjson::ObjectWriter& Writer)
+	{
+		Writer["total_size"] = CompressedClipData->get_size();
+		Writer["header_size"] = HeaderSize;
+		Writer["segment_headers_size"] = SegmentHeadersSize;
+		Writer["default_tracks_size"] = DefaultTracksSize;
+		Writer["track_metadata_size"] = TrackMetadataSize;
+		Writer["constant_track_data_size"] = ConstantTrackDataSize;
+		Writer["clip_range_data_size"] = ClipRangeDataSize;
+		Writer["segment_range_data_size"] = SegmentRangeDataSize;
+		Writer["animated_data_size"] = AnimatedDataSize;
+		Writer["num_segments"] = NumSegments;
+		Writer["num_animated_sub_tracks"] = TransformHeader.num_animated_variable_sub_tracks;
+
+		// The bit rate of every animated sub-track, per segment
+		Writer["bit_rates_per_segment"] = [&](sjson::ArrayWriter& Writer)
+		{
+			for (uint32 SegmentIndex = 0; SegmentIndex < NumSegments; ++SegmentIndex)
+			{
+				const uint8* BitRates = TransformHeader.get_format_per_track_data(SegmentHeaders[SegmentIndex]);
 
 				Writer.push_newline();
 				Writer.push([&](sjson::ArrayWriter& Writer)
 					{
-						for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+						for (uint32 SubTrackIndex = 0; SubTrackIndex < TransformHeader.num_animated_variable_sub_tracks; ++SubTrackIndex)
 						{
-							const acl::track_qvvf& Track = Tracks[BoneIndex];
-							const acl::track_desc_transformf& Desc = Track.get_description();
-
-							acl::itransform_error_metric::calculate_error_args calculate_error_args;
-							calculate_error_args.transform0 = &RawObjectPoseTransforms[BoneIndex];
-							calculate_error_args.transform1 = &LossyObjectPoseTransforms[BoneIndex];
-							calculate_error_args.construct_sphere_shell(Desc.shell_distance);
-
-							float Error;
-							if (HasScale)
-								Error = rtm::scalar_cast(ErrorMetric.calculate_error(calculate_error_args));
-							else
-								Error = rtm::scalar_cast(ErrorMetric.calculate_error_no_scale(calculate_error_args));
-
-							Writer.push(Error);
+							Writer.push(BitRates[SubTrackIndex]);
 						}
 					});
 			}
 		};
+	};
+}
 
-		acl::deallocate_type_array(Allocator, OutputBoneMapping, NumOutputBones);
+// Number of times every sample is decompressed by the sequential and random decompression benchmarks
+static constexpr int32 NumDecompressionBenchmarkPasses = 5;
+
+// Maximum number of samples decompressed by the cold cache decompression benchmark, flushing the cache is expensive
+static constexpr int32 MaxNumColdCacheDecompressionSamples = 64;
+
+// Large enough to evict the compressed data and the decompression context from every cache level
+static constexpr int32 DecompressionBenchmarkCacheFlushSize = 32 * 1024 * 1024;
+
+static void WriteDecompressionTimes(TArray<uint64>& PoseCycles, sjson::ObjectWriter& Writer)
+{
+	PoseCycles.Sort();
+
+	const int32 NumPoses = PoseCycles.Num();
+	const uint64 MedianCycles = PoseCycles[NumPoses / 2];
+	const uint64 P99Cycles = PoseCycles[FMath::Min(NumPoses - 1, (NumPoses * 99) / 100)];
+
+	Writer["num_poses"] = NumPoses;
+	Writer["min_ns"] = FPlatformTime::ToSeconds64(PoseCycles[0]) * 1.0e9;
+	Writer["median_ns"] = FPlatformTime::ToSeconds64(MedianCycles) * 1.0e9;
+	Writer["p99_ns"] = FPlatformTime::ToSeconds64(P99Cycles) * 1.0e9;
+}
+
+static void BenchmarkDecompression(FCompressionContext& Context, sjson::ObjectWriter& Writer)
+{
+	UAnimSequence* UE4Clip = Context.UE4Clip;
+	const UAnimBoneCompressionCodec* Codec = UE4Clip->CompressedData.BoneCompressionCodec;
+	if (Codec == nullptr || !UE4Clip->CompressedData.CompressedDataStructure.IsValid())
+	{
+		return;
+	}
+
+	const int32 NumTracks = UE4Clip->CompressedData.CompressedTrackToSkeletonMapTable.Num();
+	const int32 NumSamples = FMath::Max<int32>(Context.ACLTracks.get_num_samples_per_track(), 1);
+	const float SampleRate = Context.ACLTracks.get_sample_rate();
+	if (NumTracks == 0)
+	{
 		return;
 	}
 
-	Writer["error_per_frame_and_bone"] = [&](sjson::ArrayWriter& Writer)
+	// Decompress every track in its matching atom like the engine does when it samples the whole pose
+	BoneTrackArray RotationPairs;
+	BoneTrackArray TranslationPairs;
+	BoneTrackArray ScalePairs;
+	for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+	{
+		RotationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+		TranslationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+	}
+
+	if (UE4ClipHasScale(UE4Clip))
+	{
+		ScalePairs = RotationPairs;
+	}
+
+	TArray<FTransform> Atoms;
+	Atoms.AddDefaulted(NumTracks);
+	TArrayView<FTransform> OutAtoms(Atoms);
+
+	FAnimSequenceDecompressionContext DecompContext(UE4Clip->SequenceLength, UE4Clip->Interpolation, UE4Clip->GetFName(), *UE4Clip->CompressedData.CompressedDataStructure);
+
+	auto TimePoseDecompression = [&](int32 SampleIndex)
+	{
+		const float SampleTime = FMath::Min(float(SampleIndex) / SampleRate, UE4Clip->SequenceLength);
+
+		const uint64 StartTimeCycles = FPlatformTime::Cycles64();
+		DecompContext.Seek(SampleTime);
+		Codec->DecompressPose(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+		return FPlatformTime::Cycles64() - StartTimeCycles;
+	};
+
+	TArray<int32> SampleIndices;
+	SampleIndices.Reserve(NumSamples);
+	for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		SampleIndices.Add(SampleIndex);
+	}
+
+	TArray<uint64> PoseCycles;
+	PoseCycles.Reserve(NumSamples * NumDecompressionBenchmarkPasses);
+
+	Writer["decompression"] = [&](sjson::ObjectWriter& Writer)
 	{
-		for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+		Writer["sequential"] = [&](sjson::ObjectWriter& Writer)
 		{
-			// Sample our streams and calculate the error
-			const float SampleTime = rtm::scalar_min(float(SampleIndex) / SampleRate, ClipDuration);
+			// Warm up the caches first
+			TimePoseDecompression(0);
 
-			Tracks.sample_tracks(SampleTime, acl::sample_rounding_policy::none, RawWriter);
-			SampleUE4Clip(Tracks, UE4Skeleton, UE4Clip, SampleTime, LossyLocalPoseTransforms.GetData());
-
-			if (HasScale)
-			{
-				ErrorMetric.local_to_object_space(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
-				ErrorMetric.local_to_object_space(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
-			}
-			else
+			PoseCycles.Reset();
+			for (int32 Pass = 0; Pass < NumDecompressionBenchmarkPasses; ++Pass)
 			{
-				ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_raw, RawObjectPoseTransforms.GetData());
-				ErrorMetric.local_to_object_space_no_scale(local_to_object_space_args_lossy, LossyObjectPoseTransforms.GetData());
-			}
-
-			Writer.push_newline();
-			Writer.push([&](sjson::ArrayWriter& Writer)
+				for (int32 SampleIndex : SampleIndices)
 				{
-					for (uint32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
-					{
-						const acl::track_qvvf& Track = Tracks[BoneIndex];
-						const acl::track_desc_transformf& Desc = Track.get_description();
-
-						acl::itransform_error_metric::calculate_error_args calculate_error_args;
-						calculate_error_args.transform0 = &RawObjectPoseTransforms[BoneIndex];
-						calculate_error_args.transform1 = &LossyObjectPoseTransforms[BoneIndex];
-						calculate_error_args.construct_sphere_shell(Desc.shell_distance);
+					PoseCycles.Add(TimePoseDecompression(SampleIndex));
+				}
+			}
 
-						float Error;
-						if (HasScale)
-							Error = rtm::scalar_cast(ErrorMetric.calculate_error(calculate_error_args));
-						else
-							Error = rtm::scalar_cast(ErrorMetric.calculate_error_no_scale(calculate_error_args));
+			WriteDecompressionTimes(PoseCycles, Writer);
+		};
 
-						Writer.push(Error);
-					}
-				});
+		// Use a fixed seed so every run seeks in the same order
+		FRandomStream RandomStream(NumSamples);
+		for (int32 SampleIndex = NumSamples - 1; SampleIndex > 0; --SampleIndex)
+		{
+			SampleIndices.Swap(SampleIndex, RandomStream.RandRange(0, SampleIndex));
 		}
-	};
-}
 
-struct FCompressionContext
-{
-	UAnimBoneCompressionSettings* AutoCompressor;
-	UAnimBoneCompressionSettings* ACLCompressor;
-	UAnimBoneCompressionSettings* KeyReductionCompressor;
+		Writer["random"] = [&](sjson::ObjectWriter& Writer)
+		{
+			PoseCycles.Reset();
+			for (int32 Pass = 0; Pass < NumDecompressionBenchmarkPasses; ++Pass)
+			{
+				for (int32 SampleIndex : SampleIndices)
+				{
+					PoseCycles.Add(TimePoseDecompression(SampleIndex));
+				}
+			}
 
-	UAnimSequence* UE4Clip;
-	USkeleton* UE4Skeleton;
+			WriteDecompressionTimes(PoseCycles, Writer);
+		};
 
-	acl::track_array_qvvf ACLTracks;
+		Writer["cold_cache"] = [&](sjson::ObjectWriter& Writer)
+		{
+			TArray<uint8> CacheFlushBuffer;
+			CacheFlushBuffer.AddZeroed(DecompressionBenchmarkCacheFlushSize);
 
-	uint32 ACLRawSize;
-	int32 UE4RawSize;
-};
+			const int32 NumColdSamples = FMath::Min(NumSamples, MaxNumColdCacheDecompressionSamples);
 
-static FString GetCodecName(UAnimBoneCompressionCodec* Codec)
-{
-	if (Codec == nullptr)
-	{
-		return TEXT("<null>");
-	}
+			PoseCycles.Reset();
+			for (int32 Iteration = 0; Iteration < NumColdSamples; ++Iteration)
+			{
+				// Touch every cache line of the flush buffer to evict everything else
+				for (int32 Offset = 0; Offset < DecompressionBenchmarkCacheFlushSize; Offset += PLATFORM_CACHE_LINE_SIZE)
+				{
+					CacheFlushBuffer[Offset]++;
+				}
 
-	if (Codec->Description.Len() > 0 && Codec->Description != TEXT("None"))
-	{
-		return Codec->Description;
-	}
+				PoseCycles.Add(TimePoseDecompression(SampleIndices[Iteration]));
+			}
 
-	return Codec->GetClass()->GetName();
+			WriteDecompressionTimes(PoseCycles, Writer);
+		};
+	};
 }
 
 static void CompressWithUE4Auto(FCompressionContext& Context, bool PerformExhaustiveDump, sjson::Writer& Writer)
@@ -632,7 +1033,12 @@ static void CompressWithUE4Auto(FCompressionContext& Context, bool PerformExhaus
 
 			if (PerformExhaustiveDump)
 			{
-				DumpClipDetailedError(Context.ACLTracks, Context.UE4Clip, Context.UE4Skeleton, Writer);
+				DumpClipDetailedError(Context.ACLTracks, Context.UE4Clip, Context.UE4Skeleton, "ue4_auto", Context.BinaryErrorStats, Writer);
+			}
+
+			if (Context.PerformDecompressionBenchmark)
+			{
+				BenchmarkDecompression(Context, Writer);
 			}
 		};
 	}
@@ -686,9 +1092,22 @@ static void CompressWithACL(FCompressionContext& Context, bool PerformExhaustive
 			Writer["acl_worst_bone"] = WorstBone;
 			Writer["acl_worst_time"] = WorstSampleTime;
 
+			if (Context.UE4Clip->CompressedData.BoneCompressionCodec != nullptr && Context.UE4Clip->CompressedData.BoneCompressionCodec->IsA<UAnimBoneCompressionCodec_ACLBase>())
+			{
+				const FACLCompressedAnimData& AnimData = static_cast<FACLCompressedAnimData&>(*Context.UE4Clip->CompressedData.CompressedDataStructure);
+				Writer["error_threshold"] = AnimData.ErrorThreshold;
+
+				DumpACLSizeBreakdown(AnimData, Writer);
+			}
+
 			if (PerformExhaustiveDump)
 			{
-				DumpClipDetailedError(Context.ACLTracks, Context.UE4Clip, Context.UE4Skeleton, Writer);
+				DumpClipDetailedError(Context.ACLTracks, Context.UE4Clip, Context.UE4Skeleton, "ue4_acl", Context.BinaryErrorStats, Writer);
+			}
+
+			if (Context.PerformDecompressionBenchmark)
+			{
+				BenchmarkDecompression(Context, Writer);
 			}
 		};
 	}
@@ -698,6 +1117,328 @@ static void CompressWithACL(FCompressionContext& Context, bool PerformExhaustive
 	}
 }
 
+static void BenchmarkACLLoading(FCompressionContext& Context, sjson::Writer& Writer)
+{
+	UAnimSequence* UE4Clip = Context.UE4Clip;
+	if (!UE4Clip->IsCompressedDataValid() || UE4Clip->CompressedData.BoneCompressionCodec == nullptr || !UE4Clip->CompressedData.BoneCompressionCodec->IsA<UAnimBoneCompressionCodec_ACLBase>())
+	{
+		return;	// Only ACL data is benchmarked
+	}
+
+	// Serialize the compressed data once like the DDC does and load it back a number of times
+	TArray<uint8> SerializedData;
+	{
+		FMemoryWriter MemoryWriter(SerializedData);
+		UE4Clip->CompressedData.SerializeCompressedData(MemoryWriter, true, UE4Clip, Context.UE4Skeleton, UE4Clip->BoneCompressionSettings, UE4Clip->CurveCompressionSettings, false);
+	}
+
+	const int32 NumIterations = 100;
+	uint64 MinLoadCycles = MAX_uint64;
+	uint64 TotalLoadCycles = 0;
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		FCompressedAnimSequence LoadedData;
+		FMemoryReader MemoryReader(SerializedData);
+
+		const uint64 StartTimeCycles = FPlatformTime::Cycles64();
+		LoadedData.SerializeCompressedData(MemoryReader, true, UE4Clip, Context.UE4Skeleton, UE4Clip->BoneCompressionSettings, UE4Clip->CurveCompressionSettings, false);
+		const uint64 ElapsedCycles = FPlatformTime::Cycles64() - StartTimeCycles;
+
+		MinLoadCycles = FMath::Min(MinLoadCycles, ElapsedCycles);
+		TotalLoadCycles += ElapsedCycles;
+	}
+
+	Writer["ue4_acl_loading"] = [&](sjson::ObjectWriter& Writer)
+	{
+		Writer["serialized_size"] = SerializedData.Num();
+		Writer["min_load_time"] = FPlatformTime::ToSeconds64(MinLoadCycles);
+		Writer["avg_load_time"] = FPlatformTime::ToSeconds64(TotalLoadCycles) / double(NumIterations);
+	};
+}
+
+struct FCurveTimingWriter final : public acl::track_writer
+{
+	float Sum;
+
+	FCurveTimingWriter()
+		: Sum(0.0f)
+	{}
+
+	void write_float1(uint32_t /*TrackIndex*/, rtm::scalarf_arg0 Value)
+	{
+		// Accumulate to make sure the decompressed values are used
+		Sum += rtm::scalar_cast(Value);
+	}
+};
+
+static void CompressCurvesWithACL(const FCompressibleAnimData& CompressibleData, sjson::Writer& Writer)
+{
+	if (CompressibleData.RawCurveData.FloatCurves.Num() == 0)
+	{
+		return;	// Nothing to compress
+	}
+
+	UAnimCurveCompressionCodec_ACLCustom* CurveCodec = NewObject<UAnimCurveCompressionCodec_ACLCustom>(GetTransientPackage());
+	const UEnum* CompressionLevelEnum = StaticEnum<ACLCompressionLevel>();
+
+	Writer["ue4_acl_curves"] = [&](sjson::ArrayWriter& Writer)
+	{
+		for (int32 Level = ACLCL_Lowest; Level <= ACLCL_Highest; ++Level)
+		{
+			CurveCodec->CompressionLevel = static_cast<ACLCompressionLevel>(Level);
+
+			const uint64 CompressionStartTimeCycles = FPlatformTime::Cycles64();
+
+			FAnimCurveCompressionResult CompressionResult;
+			const bool bCompressed = CurveCodec->Compress(CompressibleData, CompressionResult);
+
+			const uint64 CompressionElapsedCycles = FPlatformTime::Cycles64() - CompressionStartTimeCycles;
+
+			const acl::compressed_tracks* CompressedTracks = bCompressed ? acl::make_compressed_tracks(CompressionResult.CompressedBytes.GetData()) : nullptr;
+			if (CompressedTracks == nullptr)
+			{
+				continue;
+			}
+
+			// Measure how long it takes to decompress every curve at every sample
+			acl::decompression_context<UE4CurveDecompressionSettings> Context;
+			Context.initialize(*CompressedTracks);
+
+			const uint32 NumSamples = CompressedTracks->get_num_samples_per_track();
+			const float SampleRate = CompressedTracks->get_sample_rate();
+			const float Duration = CompressedTracks->get_duration();
+
+			FCurveTimingWriter TimingWriter;
+
+			const uint64 DecompressionStartTimeCycles = FPlatformTime::Cycles64();
+			for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+			{
+				const float SampleTime = rtm::scalar_min(float(SampleIndex) / SampleRate, Duration);
+				Context.seek(SampleTime, acl::sample_rounding_policy::none);
+				Context.decompress_tracks(TimingWriter);
+			}
+			const uint64 DecompressionElapsedCycles = FPlatformTime::Cycles64() - DecompressionStartTimeCycles;
+
+			const double DecompressionTimeSec = FPlatformTime::ToSeconds64(DecompressionElapsedCycles);
+
+			Writer.push([&](sjson::ObjectWriter& Writer)
+				{
+					Writer["compression_level"] = TCHAR_TO_ANSI(*CompressionLevelEnum->GetNameStringByValue(Level));
+					Writer["num_curves"] = CompressedTracks->get_num_tracks();
+					Writer["compressed_size"] = CompressedTracks->get_size();
+					Writer["compression_time"] = FPlatformTime::ToSeconds64(CompressionElapsedCycles);
+					Writer["decompression_time"] = DecompressionTimeSec;
+					Writer["avg_decompression_time_per_sample"] = NumSamples != 0 ? (DecompressionTimeSec / double(NumSamples)) : 0.0;
+				});
+		}
+	};
+
+	CurveCodec->MarkPendingKill();
+}
+
+struct FACLSweepResult
+{
+	ACLCompressionLevel CompressionLevel;
+	float ErrorThreshold;
+	float VirtualVertexDistance;
+	float VirtualVertexDistanceScale;
+	uint16 IdealNumKeyFramesPerSegment;
+	uint16 MaxNumKeyFramesPerSegment;
+
+	acl::compression_settings Settings;
+
+	// Kept between the parallel compression pass and the serial decompression pass
+	acl::compressed_tracks* CompressedTracks = nullptr;
+
+	uint32 CompressedSize = 0;
+	float MaxError = 0.0f;
+	double CompressionTime = 0.0;
+	double DecompressionTimeNs = 0.0;
+	bool bIsValid = false;
+	bool bIsParetoOptimal = false;
+
+	// Whether this result is at least as good in every dimension and strictly better in one
+	bool Dominates(const FACLSweepResult& Other) const
+	{
+		const bool bNoWorse = CompressedSize <= Other.CompressedSize && MaxError <= Other.MaxError && DecompressionTimeNs <= Other.DecompressionTimeNs;
+		const bool bBetter = CompressedSize < Other.CompressedSize || MaxError < Other.MaxError || DecompressionTimeNs < Other.DecompressionTimeNs;
+		return bNoWorse && bBetter;
+	}
+};
+
+static void SweepACLSettings(FCompressionContext& Context, const TArray<float>& ErrorThresholds, const TArray<float>& VirtualVertexDistances, float DefaultVirtualVertexDistance, sjson::Writer& Writer)
+{
+	static const ACLCompressionLevel CompressionLevels[] = { ACLCL_Low, ACLCL_Medium, ACLCL_High, ACLCL_Highest };
+	static const uint16 SegmentSizes[][2] = { { 8, 15 }, { 16, 31 }, { 32, 63 } };
+
+	const acl::track_array_qvvf& RawTracks = Context.ACLTracks;
+	const uint32 NumTracks = RawTracks.get_num_tracks();
+	const uint32 NumSamples = RawTracks.get_num_samples_per_track();
+	if (NumTracks == 0 || NumSamples == 0)
+	{
+		return;
+	}
+
+	// Build the grid on the main thread, the codec only generates the ACL settings
+	UAnimBoneCompressionCodec_ACLCustom* SweepCodec = NewObject<UAnimBoneCompressionCodec_ACLCustom>(GetTransientPackage());
+
+	TArray<FACLSweepResult> Results;
+	for (ACLCompressionLevel CompressionLevel : CompressionLevels)
+	{
+		for (const uint16* SegmentSize : SegmentSizes)
+		{
+			SweepCodec->CompressionLevel = CompressionLevel;
+			SweepCodec->IdealNumKeyFramesPerSegment = SegmentSize[0];
+			SweepCodec->MaxNumKeyFramesPerSegment = SegmentSize[1];
+
+			acl::compression_settings Settings;
+			SweepCodec->GetCompressionSettings(Settings);
+
+			for (float ErrorThreshold : ErrorThresholds)
+			{
+				for (float VirtualVertexDistance : VirtualVertexDistances)
+				{
+					FACLSweepResult& Result = Results.AddDefaulted_GetRef();
+					Result.CompressionLevel = CompressionLevel;
+					Result.ErrorThreshold = ErrorThreshold;
+					Result.VirtualVertexDistance = VirtualVertexDistance;
+					Result.VirtualVertexDistanceScale = VirtualVertexDistance / DefaultVirtualVertexDistance;
+					Result.IdealNumKeyFramesPerSegment = SegmentSize[0];
+					Result.MaxNumKeyFramesPerSegment = SegmentSize[1];
+					Result.Settings = Settings;
+				}
+			}
+		}
+	}
+
+	SweepCodec->MarkPendingKill();
+
+	// A single allocator is shared by every task, it is stateless and thread safe
+	ACLAllocator Allocator;
+
+	// Compress every grid point in parallel, the decompression time is measured afterwards without contention
+	ParallelFor(Results.Num(), [&](int32 ResultIndex)
+	{
+		FACLSweepResult& Result = Results[ResultIndex];
+
+		// Reference the raw data and only change the description of every track
+		acl::track_array_qvvf Tracks(Allocator, NumTracks);
+		for (uint32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+		{
+			Tracks[TrackIndex] = RawTracks[TrackIndex].get_ref();
+
+			acl::track_desc_transformf& Desc = Tracks[TrackIndex].get_description();
+			Desc.precision = Result.ErrorThreshold;
+
+			// Every track is scaled relative to its original distance, bones that use the safe distance stay proportionally safer.
+			// This doesn't depend on the input using exactly the codec default, *.acl.sjson clips carry their own distances.
+			Desc.shell_distance = RawTracks[TrackIndex].get_description().shell_distance * Result.VirtualVertexDistanceScale;
+		}
+
+		const acl::qvvf_transform_error_metric ErrorMetric;
+		acl::compression_settings Settings = Result.Settings;
+		Settings.error_metric = &ErrorMetric;
+
+		acl::output_stats Stats;
+		acl::compressed_tracks* CompressedTracks = nullptr;
+
+		const uint64 CompressionStartTimeCycles = FPlatformTime::Cycles64();
+		const acl::error_result CompressionResult = acl::compress_track_list(Allocator, Tracks, Settings, CompressedTracks, Stats);
+		const uint64 CompressionElapsedCycles = FPlatformTime::Cycles64() - CompressionStartTimeCycles;
+
+		if (CompressionResult.any())
+		{
+			return;
+		}
+
+		// The default decompression settings are used since the variable formats are always used
+		acl::decompression_context<UE4DefaultDecompressionSettings> DecompContext;
+		DecompContext.initialize(*CompressedTracks);
+
+		// The error is measured against the raw tracks with their original virtual vertex distance to be comparable
+		const acl::track_error TrackError = acl::calculate_compression_error(Allocator, RawTracks, DecompContext, ErrorMetric);
+
+		Result.CompressedTracks = CompressedTracks;
+		Result.CompressedSize = CompressedTracks->get_size();
+		Result.MaxError = TrackError.error;
+		Result.CompressionTime = FPlatformTime::ToSeconds64(CompressionElapsedCycles);
+		Result.bIsValid = true;
+	});
+
+	// Decompression is timed serially, it is a Pareto dimension and must not be skewed by the other tasks
+	TArray<rtm::qvvf> Pose;
+	Pose.AddUninitialized(NumTracks);
+	SimpleTransformWriter PoseWriter(Pose);
+
+	const float SampleRate = RawTracks.get_sample_rate();
+	const float Duration = RawTracks.get_duration();
+
+	for (FACLSweepResult& Result : Results)
+	{
+		if (!Result.bIsValid)
+		{
+			continue;
+		}
+
+		acl::decompression_context<UE4DefaultDecompressionSettings> DecompContext;
+		DecompContext.initialize(*Result.CompressedTracks);
+
+		// Keep the fastest pass to reduce the noise
+		uint64 MinDecompressionCycles = MAX_uint64;
+		for (int32 Pass = 0; Pass < 3; ++Pass)
+		{
+			const uint64 DecompressionStartTimeCycles = FPlatformTime::Cycles64();
+			for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+			{
+				const float SampleTime = rtm::scalar_min(float(SampleIndex) / SampleRate, Duration);
+				DecompContext.seek(SampleTime, acl::sample_rounding_policy::none);
+				DecompContext.decompress_tracks(PoseWriter);
+			}
+			MinDecompressionCycles = FMath::Min(MinDecompressionCycles, FPlatformTime::Cycles64() - DecompressionStartTimeCycles);
+		}
+
+		Result.DecompressionTimeNs = FPlatformTime::ToSeconds64(MinDecompressionCycles) * 1.0e9 / double(NumSamples);
+
+		Allocator.deallocate(Result.CompressedTracks, Result.CompressedSize);
+		Result.CompressedTracks = nullptr;
+	}
+
+	for (FACLSweepResult& Result : Results)
+	{
+		Result.bIsParetoOptimal = Result.bIsValid && !Results.ContainsByPredicate([&Result](const FACLSweepResult& Other) { return Other.bIsValid && Other.Dominates(Result); });
+	}
+
+	const UEnum* CompressionLevelEnum = StaticEnum<ACLCompressionLevel>();
+
+	Writer["ue4_acl_sweep"] = [&](sjson::ArrayWriter& Writer)
+	{
+		for (const FACLSweepResult& Result : Results)
+		{
+			if (!Result.bIsValid)
+			{
+				continue;
+			}
+
+			Writer.push_newline();
+			Writer.push([&](sjson::ObjectWriter& Writer)
+				{
+					Writer["compression_level"] = TCHAR_TO_ANSI(*CompressionLevelEnum->GetNameStringByValue(Result.CompressionLevel));
+					Writer["error_threshold"] = Result.ErrorThreshold;
+					Writer["virtual_vertex_distance"] = Result.VirtualVertexDistance;
+					Writer["virtual_vertex_distance_scale"] = Result.VirtualVertexDistanceScale;
+					Writer["ideal_num_key_frames_per_segment"] = Result.IdealNumKeyFramesPerSegment;
+					Writer["max_num_key_frames_per_segment"] = Result.MaxNumKeyFramesPerSegment;
+					Writer["compressed_size"] = Result.CompressedSize;
+					Writer["max_error"] = Result.MaxError;
+					Writer["compression_time"] = Result.CompressionTime;
+					Writer["decompression_time_ns"] = Result.DecompressionTimeNs;
+					Writer["is_pareto_optimal"] = Result.bIsParetoOptimal;
+				});
+		}
+	};
+}
+
 static bool IsKeyDropped(int32 NumFrames, const uint8* FrameTable, int32 NumKeys, float FrameRate, float SampleTime)
 {
 	if (NumFrames > 0xFF)
@@ -777,7 +1518,12 @@ static void CompressWithUE4KeyReduction(FCompressionContext& Context, bool Perfo
 
 			if (PerformExhaustiveDump)
 			{
-				DumpClipDetailedError(Context.ACLTracks, Context.UE4Clip, Context.UE4Skeleton, Writer);
+				DumpClipDetailedError(Context.ACLTracks, Context.UE4Clip, Context.UE4Skeleton, "ue4_keyreduction", Context.BinaryErrorStats, Writer);
+			}
+
+			if (Context.PerformDecompressionBenchmark)
+			{
+				BenchmarkDecompression(Context, Writer);
 			}
 
 			// Number of animated keys before any key reduction for animated tracks (without constant/default tracks)
@@ -1037,7 +1783,7 @@ struct CompressAnimationsFunctor
 			FString Filename = UE4Clip->GetPathName();
 			if (StatsCommandlet->PerformCompression)
 			{
-				Filename = FString::Printf(TEXT("%X_stats.sjson"), GetTypeHash(Filename));
+				Filename = FString::Printf(TEXT("%X_stats.sjson%s"), GetTypeHash(Filename), StatsCommandlet->CompressOutput ? TEXT(".gz") : TEXT(""));
 			}
 			else if (StatsCommandlet->PerformClipExtraction)
 			{
@@ -1062,6 +1808,7 @@ struct CompressAnimationsFunctor
 			Context.ACLCompressor = StatsCommandlet->ACLCompressionSettings;
 			Context.UE4Clip = UE4Clip;
 			Context.UE4Skeleton = UE4Skeleton;
+			Context.PerformDecompressionBenchmark = StatsCommandlet->PerformDecompressionBenchmark;
 
 			FCompressibleAnimData CompressibleData(UE4Clip, false);
 
@@ -1092,9 +1839,15 @@ struct CompressAnimationsFunctor
 				// Make sure any pending async compression that might have started during load or construction is done
 				UE4Clip->WaitOnExistingCompression();
 
-				UE4SJSONStreamWriter StreamWriter(OutputWriter);
+				UE4SJSONStreamWriter StreamWriter(OutputWriter, StatsCommandlet->CompressOutput);
 				sjson::Writer Writer(StreamWriter);
 
+				FACLBinaryErrorStatsWriter BinaryErrorStats;
+				if (StatsCommandlet->PerformExhaustiveDump && StatsCommandlet->BinaryErrorOutput)
+				{
+					Context.BinaryErrorStats = &BinaryErrorStats;
+				}
+
 				Writer["duration"] = UE4Clip->SequenceLength;
 				Writer["num_samples"] = CompressibleData.NumFrames;
 				Writer["ue4_raw_size"] = Context.UE4RawSize;
@@ -1108,6 +1861,11 @@ struct CompressAnimationsFunctor
 				if (StatsCommandlet->TryACLCompression)
 				{
 					CompressWithACL(Context, StatsCommandlet->PerformExhaustiveDump, Writer);
+
+					if (StatsCommandlet->PerformLoadBenchmark)
+					{
+						BenchmarkACLLoading(Context, Writer);
+					}
 				}
 
 				if (StatsCommandlet->TryKeyReduction)
@@ -1115,7 +1873,32 @@ struct CompressAnimationsFunctor
 					CompressWithUE4KeyReduction(Context, StatsCommandlet->PerformExhaustiveDump, Writer);
 				}
 
-				OutputWriter->Close();
+				if (StatsCommandlet->TryCurveCompression)
+				{
+					CompressCurvesWithACL(CompressibleData, Writer);
+				}
+
+				if (StatsCommandlet->PerformSettingsSweep)
+				{
+					SweepACLSettings(Context, StatsCommandlet->SweepErrorThresholds, StatsCommandlet->SweepVirtualVertexDistances, StatsCommandlet->ACLCodec->DefaultVirtualVertexDistance, Writer);
+				}
+
+				if (!StreamWriter.Close())
+				{
+					UE_LOG(LogAnimationCompression, Error, TEXT("Failed to write the stats of %s, the output is discarded"), *UE4Clip->GetPathName());
+					FileManager.Delete(*UE4OutputPath);
+				}
+
+				if (!BinaryErrorStats.IsEmpty())
+				{
+					const FString BinaryErrorPath = FPaths::Combine(*StatsCommandlet->OutputDir, *FString::Printf(TEXT("%X_error.bin"), GetTypeHash(UE4Clip->GetPathName()))).Replace(TEXT("/"), TEXT("\\"));
+					if (!BinaryErrorStats.Save(FileManager, BinaryErrorPath))
+					{
+						// Discard the stats as well so the clip is processed again when resuming
+						UE_LOG(LogAnimationCompression, Error, TEXT("Failed to write the binary error stats of %s: %s, the output is discarded"), *UE4Clip->GetPathName(), *BinaryErrorPath);
+						FileManager.Delete(*UE4OutputPath);
+					}
+				}
 			}
 			else if (StatsCommandlet->PerformClipExtraction)
 			{
@@ -1170,6 +1953,12 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 	TryACLCompression = Switches.Contains(TEXT("acl"));
 	TryKeyReductionRetarget = Switches.Contains(TEXT("keyreductionrt"));
 	TryKeyReduction = TryKeyReductionRetarget || Switches.Contains(TEXT("keyreduction"));
+	TryCurveCompression = Switches.Contains(TEXT("curves"));
+	PerformLoadBenchmark = Switches.Contains(TEXT("loadbench"));
+	PerformDecompressionBenchmark = Switches.Contains(TEXT("decompbench"));
+	CompressOutput = Switches.Contains(TEXT("gzip"));
+	BinaryErrorOutput = Switches.Contains(TEXT("binary"));
+	PerformSettingsSweep = Switches.Contains(TEXT("sweep"));
 	ResumeTask = Switches.Contains(TEXT("resume"));
 	SkipAdditiveClips = Switches.Contains(TEXT("noadditive")) || true;	// Disabled for now, TODO add support for it
 	const bool HasInput = ParamsMap.Contains(TEXT("input"));
@@ -1212,7 +2001,7 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 		}
 	}
 
-	if (TryACLCompression || !HasInput)
+	if (TryACLCompression || PerformSettingsSweep || !HasInput)
 	{
 		ACLCompressionSettings = NewObject<UAnimBoneCompressionSettings>(this, UAnimBoneCompressionSettings::StaticClass());
 		ACLCodec = NewObject<UAnimBoneCompressionCodec_ACL>(this, UAnimBoneCompressionCodec_ACL::StaticClass());
@@ -1220,6 +2009,25 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 		ACLCompressionSettings->AddToRoot();
 	}
 
+	if (PerformSettingsSweep)
+	{
+		auto ParseSweepValues = [&ParamsMap](const TCHAR* ParamName, const TCHAR* DefaultValues, TArray<float>& OutValues)
+		{
+			const FString* Param = ParamsMap.Find(ParamName);
+
+			TArray<FString> Values;
+			(Param != nullptr ? *Param : FString(DefaultValues)).ParseIntoArray(Values, TEXT(","));
+
+			for (const FString& Value : Values)
+			{
+				OutValues.Add(FCString::Atof(*Value));
+			}
+		};
+
+		ParseSweepValues(TEXT("SweepErrorThresholds"), TEXT("0.001,0.01,0.1"), SweepErrorThresholds);
+		ParseSweepValues(TEXT("SweepVirtualVertexDistances"), TEXT("1,3,10"), SweepVirtualVertexDistances);
+	}
+
 	if (TryKeyReduction)
 	{
 		KeyReductionCompressionSettings = NewObject<UAnimBoneCompressionSettings>(this, UAnimBoneCompressionSettings::StaticClass());
@@ -1261,7 +2069,7 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 		for (const FString& Filename : Files)
 		{
 			const FString ACLClipPath = FPaths::Combine(*ACLRawDir, *Filename);
-			const FString UE4StatPath = FPaths::Combine(*OutputDir, *Filename.Replace(TEXT(".acl.sjson"), TEXT("_stats.sjson"), ESearchCase::CaseSensitive));
+			const FString UE4StatPath = FPaths::Combine(*OutputDir, *Filename.Replace(TEXT(".acl.sjson"), CompressOutput ? TEXT("_stats.sjson.gz") : TEXT("_stats.sjson"), ESearchCase::CaseSensitive));
 
 			if (ResumeTask && FileManager.FileExists(*UE4StatPath))
 			{
@@ -1278,10 +2086,11 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 				continue;
 			}
 
-			UE4SJSONStreamWriter StreamWriter(StatWriter);
+			UE4SJSONStreamWriter StreamWriter(StatWriter, CompressOutput);
 			sjson::Writer Writer(StreamWriter);
 
 			acl::track_array_qvvf ACLTracks;
+			bool bFailedToWriteOutput = false;
 
 			const TCHAR* ErrorMsg = ReadACLClip(FileManager, ACLClipPath, Allocator, ACLTracks);
 			if (ErrorMsg == nullptr)
@@ -1302,6 +2111,13 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 				Context.UE4Clip = UE4Clip;
 				Context.UE4Skeleton = UE4Skeleton;
 				Context.ACLTracks = MoveTemp(ACLTracks);
+				Context.PerformDecompressionBenchmark = PerformDecompressionBenchmark;
+
+				FACLBinaryErrorStatsWriter BinaryErrorStats;
+				if (PerformExhaustiveDump && BinaryErrorOutput)
+				{
+					Context.BinaryErrorStats = &BinaryErrorStats;
+				}
 
 				Context.ACLRawSize = Context.ACLTracks.get_raw_size();
 				Context.UE4RawSize = UE4Clip->GetApproxRawSize();
@@ -1338,6 +2154,21 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 					UE4Clip->ClearCompressedCurveData();
 				}
 
+				if (PerformSettingsSweep)
+				{
+					SweepACLSettings(Context, SweepErrorThresholds, SweepVirtualVertexDistances, ACLCodec->DefaultVirtualVertexDistance, Writer);
+				}
+
+				if (!BinaryErrorStats.IsEmpty())
+				{
+					const FString BinaryErrorPath = FPaths::Combine(*OutputDir, *Filename.Replace(TEXT(".acl.sjson"), TEXT("_error.bin"), ESearchCase::CaseSensitive));
+					if (!BinaryErrorStats.Save(FileManager, BinaryErrorPath))
+					{
+						UE_LOG(LogAnimationCompression, Error, TEXT("Failed to write the binary error stats of %s: %s"), *Filename, *BinaryErrorPath);
+						bFailedToWriteOutput = true;
+					}
+				}
+
 				UE4Clip->RecycleAnimSequence();
 			}
 			else
@@ -1345,7 +2176,12 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 				Writer["error"] = TCHAR_TO_ANSI(ErrorMsg);
 			}
 
-			StatWriter->Close();
+			if (!StreamWriter.Close() || bFailedToWriteOutput)
+			{
+				// Discard the stats so the clip is processed again when resuming
+				UE_LOG(LogAnimationCompression, Error, TEXT("Failed to write the stats of %s, the output is discarded"), *Filename);
+				FileManager.Delete(*UE4StatPath);
+			}
 		}
 	}
 #endif	// WITH_EDITOR
@@ -13,12 +13,18 @@
 #endif	// WITH_EDITORONLY_DATA
 
 #include "ACLDecompressionImpl.h"
+#include "ACLDecompressionKernels.h"
 
 UAnimBoneCompressionCodec_ACL::UAnimBoneCompressionCodec_ACL(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 #if WITH_EDITORONLY_DATA
 	SafetyFallbackThreshold = 1.0f;			// 1cm, should be very rarely exceeded
+
+	bStripUnusedBones = false;
+	bUseLODBonePrecision = false;
+	LODBoneErrorThresholdScale = 2.0f;
+	LODBoneShellDistanceScale = 0.5f;
 #endif	// WITH_EDITORONLY_DATA
 }
 
@@ -83,6 +89,13 @@ ACLSafetyFallbackResult UAnimBoneCompressionCodec_ACL::ExecuteSafetyFallback(acl
 	return ACLSafetyFallbackResult::Ignored;
 }
 
+bool UAnimBoneCompressionCodec_ACL::GetLODBonePrecision(float& OutErrorThresholdScale, float& OutShellDistanceScale) const
+{
+	OutErrorThresholdScale = LODBoneErrorThresholdScale;
+	OutShellDistanceScale = LODBoneShellDistanceScale;
+	return bUseLODBonePrecision;
+}
+
 void UAnimBoneCompressionCodec_ACL::PopulateDDCKey(FArchive& Ar)
 {
 	Super::PopulateDDCKey(Ar);
@@ -104,6 +117,18 @@ void UAnimBoneCompressionCodec_ACL::PopulateDDCKey(FArchive& Ar)
 		}
 	}
 
+	Ar << bStripUnusedBones;
+	if (bStripUnusedBones)
+	{
+		PopulateSocketBonesDDCKey(Ar, OptimizationTargets);
+	}
+
+	Ar << bUseLODBonePrecision;
+	if (bUseLODBonePrecision)
+	{
+		Ar << LODBoneErrorThresholdScale << LODBoneShellDistanceScale;
+	}
+
 	if (SafetyFallbackCodec != nullptr)
 	{
 		SafetyFallbackCodec->PopulateDDCKey(Ar);
@@ -126,10 +151,10 @@ UAnimBoneCompressionCodec* UAnimBoneCompressionCodec_ACL::GetCodec(const FString
 
 void UAnimBoneCompressionCodec_ACL::DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms) const
 {
-	::DecompressPose<UE4DefaultDecompressionSettings>(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+	GACLDecompressionKernels.Default.DecompressPose(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
 }
 
 void UAnimBoneCompressionCodec_ACL::DecompressBone(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom) const
 {
-	::DecompressBone<UE4DefaultDecompressionSettings>(DecompContext, TrackIndex, OutAtom);
+	GACLDecompressionKernels.Default.DecompressBone(DecompContext, TrackIndex, OutAtom);
 }
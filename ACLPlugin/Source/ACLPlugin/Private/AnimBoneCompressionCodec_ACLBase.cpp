@@ -3,10 +3,21 @@
 #include "AnimBoneCompressionCodec_ACLBase.h"
 #include "Serialization/MemoryWriter.h"
 #include "Serialization/MemoryReader.h"
+#include "HAL/ThreadSafeCounter.h"
+
+#include "ACLDecompressionImpl.h"
+
+#if WITH_EDITOR
+#include "ACLFormatManifest.h"
+#endif
 
 #if WITH_EDITORONLY_DATA
 #include "AnimBoneCompressionCodec_ACLSafe.h"
+#include "AnimCurveCompressionCodec_ACL.h"
 #include "Animation/AnimationSettings.h"
+#include "Animation/AnimCurveCompressionSettings.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMeshSocket.h"
 #include "Rendering/SkeletalMeshModel.h"
 
 #include "ACLImpl.h"
@@ -19,15 +30,90 @@
 
 #include <acl/core/compressed_tracks.h>
 
-bool FACLCompressedAnimData::IsValid() const
+#if WITH_ACL_TELEMETRY
+#include "HAL/IConsoleManager.h"
+
+int32 GACLEnableTelemetry = 0;
+static FAutoConsoleVariableRef CVarACLEnableTelemetry(
+	TEXT("ACL.EnableTelemetry"),
+	GACLEnableTelemetry,
+	TEXT("Whether to gather the per anim sequence decompression statistics reported by ACL.Telemetry. Timing every decompression call has a small cost."),
+	ECVF_Default);
+#endif
+
+static bool IsCompressedDataValid(const TArrayView<uint8>& CompressedData)
 {
-	if (CompressedByteStream.Num() == 0)
+	if (CompressedData.Num() == 0)
 	{
 		return false;
 	}
 
-	const acl::compressed_tracks* CompressedClipData = acl::make_compressed_tracks(CompressedByteStream.GetData());
-	return CompressedClipData != nullptr && CompressedClipData->is_valid(false).empty();
+	const acl::compressed_tracks* CompressedTracks = acl::make_compressed_tracks(CompressedData.GetData());
+	return CompressedTracks != nullptr && CompressedTracks->is_valid(false).empty();
+}
+
+void FACLCompressedAnimData::SerializeCompressedData(FArchive& Ar)
+{
+	ICompressedAnimData::SerializeCompressedData(Ar);
+
+	// When loading, the bulk data is bound before it is read, ByteSwapIn validates it once it is populated
+	bIsLoadingBulkData = Ar.IsLoading();
+
+	Ar << CompressedCurveOffset << CompressedCurveSize;
+
+#if WITH_EDITORONLY_DATA
+	if (!Ar.IsFilterEditorOnly())
+	{
+		Ar << ErrorThreshold;
+	}
+#endif
+
+#if WITH_EDITOR
+	if (Ar.IsSaving() && Ar.IsCooking() && bRecordFormatUsage && bIsBoneDataValid)
+	{
+		RecordACLFormatUsage(CompressedByteStream);
+	}
+#endif
+}
+
+void FACLCompressedAnimData::Bind(const TArrayView<uint8> BulkData)
+{
+	static FThreadSafeCounter NextBindId;
+	BindId = uint32(NextBindId.Increment());
+
+	// The bulk data is the engine owned compressed byte stream, we reference it in place without copying
+	// Its heap allocation is 16 byte aligned which is what ACL requires
+	checkf(BulkData.Num() == 0 || IsAligned(BulkData.GetData(), 16), TEXT("ACL compressed data must be 16 byte aligned"));
+
+	if (CompressedCurveSize != 0)
+	{
+		// Curves are stored after the bone data in the same buffer
+		CompressedByteStream = BulkData.Slice(0, CompressedCurveOffset);
+		CompressedCurveByteStream = BulkData.Slice(CompressedCurveOffset, CompressedCurveSize);
+	}
+	else
+	{
+		CompressedByteStream = BulkData;
+		CompressedCurveByteStream = TArrayView<uint8>();
+	}
+
+	if (bIsLoadingBulkData)
+	{
+		// The bytes haven't been read yet
+		bIsBoneDataValid = false;
+		bIsCurveDataValid = false;
+		bIsSupportedByFormatManifest = false;
+		return;
+	}
+
+	Validate();
+}
+
+void FACLCompressedAnimData::Validate()
+{
+	bIsBoneDataValid = IsCompressedDataValid(CompressedByteStream);
+	bIsCurveDataValid = CompressedCurveSize != 0 && IsCompressedDataValid(CompressedCurveByteStream);
+	bIsSupportedByFormatManifest = bIsBoneDataValid && IsSupportedByFormatManifest(*acl::make_compressed_tracks(CompressedByteStream.GetData()));
 }
 
 UAnimBoneCompressionCodec_ACLBase::UAnimBoneCompressionCodec_ACLBase(const FObjectInitializer& ObjectInitializer)
@@ -43,6 +129,12 @@ UAnimBoneCompressionCodec_ACLBase::UAnimBoneCompressionCodec_ACLBase(const FObje
 	SafeVirtualVertexDistance = 100.0f;		// 100cm
 
 	ErrorThreshold = 0.01f;					// 0.01cm, conservative enough for cinematographic quality
+
+	MemoryBudgetMode = ACLMBM_Disabled;
+	MemoryBudget = 16 * 1024;				// 16KB
+	MinErrorThreshold = 0.001f;				// 0.001cm
+	MaxErrorThreshold = 0.1f;				// 0.1cm, the UE4 default master tolerance
+	MaxNumMemoryBudgetIterations = 8;
 #endif	// WITH_EDITORONLY_DATA
 }
 
@@ -168,6 +260,338 @@ static void PopulateShellDistanceFromOptimizationTargets(const FCompressibleAnim
 	}
 }
 
+static void AppendUsedBones(USkeletalMesh* OptimizationTarget, TSet<FName>& UsedBoneNames)
+{
+	const FSkeletalMeshModel* MeshModel = OptimizationTarget != nullptr ? OptimizationTarget->GetImportedModel() : nullptr;
+	if (MeshModel == nullptr || MeshModel->LODModels.Num() == 0)
+	{
+		return;	// No data to work with
+	}
+
+	const FReferenceSkeleton& RefSkeleton = OptimizationTarget->RefSkeleton;
+
+	// Every bone that influences a vertex is used, the lower LODs only ever reference a subset of LOD0
+	for (const FSkelMeshSection& Section : MeshModel->LODModels[0].Sections)
+	{
+		for (const FSoftSkinVertex& VertexInfo : Section.SoftVertices)
+		{
+			for (uint32 InfluenceIndex = 0; InfluenceIndex < MAX_TOTAL_INFLUENCES; ++InfluenceIndex)
+			{
+				if (VertexInfo.InfluenceWeights[InfluenceIndex] != 0)
+				{
+					const uint32 SectionBoneIndex = VertexInfo.InfluenceBones[InfluenceIndex];
+					const int32 BoneIndex = Section.BoneMap[SectionBoneIndex];
+					UsedBoneNames.Add(RefSkeleton.GetBoneName(BoneIndex));
+				}
+			}
+		}
+	}
+
+	// Sockets that only live on the mesh are used as well, skeleton sockets are already flagged in the bone data
+	for (const USkeletalMeshSocket* Socket : OptimizationTarget->GetMeshOnlySocketList())
+	{
+		if (Socket != nullptr)
+		{
+			UsedBoneNames.Add(Socket->BoneName);
+		}
+	}
+}
+
+static void StripUnusedBones(const FCompressibleAnimData& CompressibleAnimData, const TArray<USkeletalMesh*>& OptimizationTargets, acl::track_array_qvvf& ACLTracks)
+{
+	TSet<FName> UsedBoneNames;
+	for (USkeletalMesh* OptimizationTarget : OptimizationTargets)
+	{
+		AppendUsedBones(OptimizationTarget, UsedBoneNames);
+	}
+
+	const int32 NumBones = CompressibleAnimData.BoneData.Num();
+
+	TBitArray<> IsBoneUsed(false, NumBones);
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		const FBoneData& UE4Bone = CompressibleAnimData.BoneData[BoneIndex];
+		IsBoneUsed[BoneIndex] = BoneIndex == 0 || UE4Bone.bHasSocket || UsedBoneNames.Contains(UE4Bone.Name);
+	}
+
+	// A used bone needs its whole parent chain, parents always come before their children
+	for (int32 BoneIndex = NumBones - 1; BoneIndex > 0; --BoneIndex)
+	{
+		const int32 ParentBoneIndex = CompressibleAnimData.BoneData[BoneIndex].GetParent();
+		if (IsBoneUsed[BoneIndex] && ParentBoneIndex != INDEX_NONE)
+		{
+			IsBoneUsed[ParentBoneIndex] = true;
+		}
+	}
+
+	// Additive sequences store the delta from the base, the bind pose is the identity
+	const bool bIsAdditive = CompressibleAnimData.bIsValidAdditive;
+	const rtm::vector4f ACLDefaultScale = rtm::vector_set(bIsAdditive ? 0.0f : 1.0f);
+
+	int32 NumStrippedBones = 0;
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		if (IsBoneUsed[BoneIndex])
+		{
+			continue;
+		}
+
+		// The bind pose is constant which ACL stores as a single sample without any per frame data
+		const FBoneData& UE4Bone = CompressibleAnimData.BoneData[BoneIndex];
+		const rtm::qvvf BindTransform = bIsAdditive ? rtm::qvv_set(rtm::quat_identity(), rtm::vector_zero(), ACLDefaultScale) : rtm::qvv_set(QuatCast(UE4Bone.Orientation), VectorCast(UE4Bone.Position), ACLDefaultScale);
+
+		acl::track_qvvf& ACLTrack = ACLTracks[BoneIndex];
+		const uint32 NumSamples = ACLTrack.get_num_samples();
+		for (uint32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+		{
+			ACLTrack[SampleIndex] = BindTransform;
+		}
+
+		NumStrippedBones++;
+	}
+
+	UE_LOG(LogAnimationCompression, Verbose, TEXT("ACL stripped %d unused bones out of %d"), NumStrippedBones, NumBones);
+}
+
+void UAnimBoneCompressionCodec_ACLBase::PopulateSocketBonesDDCKey(FArchive& Ar, const TArray<USkeletalMesh*>& OptimizationTargets)
+{
+	// The mesh model GUID doesn't change when a socket is added to the mesh or to its skeleton
+	TArray<FString> SocketBoneNames;
+	for (USkeletalMesh* OptimizationTarget : OptimizationTargets)
+	{
+		if (OptimizationTarget == nullptr)
+		{
+			continue;
+		}
+
+		for (const USkeletalMeshSocket* Socket : OptimizationTarget->GetMeshOnlySocketList())
+		{
+			if (Socket != nullptr)
+			{
+				SocketBoneNames.AddUnique(Socket->BoneName.ToString());
+			}
+		}
+
+		if (OptimizationTarget->Skeleton != nullptr)
+		{
+			for (const USkeletalMeshSocket* Socket : OptimizationTarget->Skeleton->Sockets)
+			{
+				if (Socket != nullptr)
+				{
+					SocketBoneNames.AddUnique(Socket->BoneName.ToString());
+				}
+			}
+		}
+	}
+
+	// Names are hashed as strings in a stable order, FName indices differ between runs
+	SocketBoneNames.Sort();
+	for (FString& BoneName : SocketBoneNames)
+	{
+		Ar << BoneName;
+	}
+}
+
+static void AppendNumMissingLODs(USkeletalMesh* OptimizationTarget, TMap<FName, int32>& BoneNumMissingLODsMap)
+{
+	const FSkeletalMeshModel* MeshModel = OptimizationTarget != nullptr ? OptimizationTarget->GetImportedModel() : nullptr;
+	if (MeshModel == nullptr || MeshModel->LODModels.Num() == 0)
+	{
+		return;	// No data to work with
+	}
+
+	const FReferenceSkeleton& RefSkeleton = OptimizationTarget->RefSkeleton;
+	const int32 NumBones = RefSkeleton.GetNum();
+	const int32 NumLODs = MeshModel->LODModels.Num();
+
+	// Find the last LOD that requires each bone, bones required by a LOD are also required by all the higher detail LODs
+	TArray<int32> LastRequiredLODPerBone;
+	LastRequiredLODPerBone.Init(INDEX_NONE, NumBones);
+
+	for (int32 LODIndex = 0; LODIndex < NumLODs; ++LODIndex)
+	{
+		for (const FBoneIndexType BoneIndex : MeshModel->LODModels[LODIndex].RequiredBones)
+		{
+			if (LastRequiredLODPerBone.IsValidIndex(BoneIndex))
+			{
+				LastRequiredLODPerBone[BoneIndex] = FMath::Max<int32>(LastRequiredLODPerBone[BoneIndex], LODIndex);
+			}
+		}
+	}
+
+	// Store the results in a map by bone name since the optimizing target might use a different
+	// skeleton mapping. When multiple meshes use a bone, the one that needs it the longest wins.
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		const int32 LastRequiredLOD = LastRequiredLODPerBone[BoneIndex];
+		if (LastRequiredLOD == INDEX_NONE)
+		{
+			continue;	// Unused by this mesh, it has no say
+		}
+
+		const int32 NumMissingLODs = NumLODs - 1 - LastRequiredLOD;
+
+		const FName BoneName = RefSkeleton.GetBoneName(BoneIndex);
+		int32* BoneNumMissingLODs = BoneNumMissingLODsMap.Find(BoneName);
+		if (BoneNumMissingLODs != nullptr)
+		{
+			*BoneNumMissingLODs = FMath::Min(*BoneNumMissingLODs, NumMissingLODs);
+		}
+		else
+		{
+			BoneNumMissingLODsMap.Add(BoneName, NumMissingLODs);
+		}
+	}
+}
+
+// Returns the precision scale for every track, bones that are removed from the lower mesh LODs are only evaluated up close
+// where their small features are drawn by few pixels and as such, they can use a looser precision.
+static TArray<float> PopulateLODPrecisionFromOptimizationTargets(const TArray<USkeletalMesh*>& OptimizationTargets, float LODBoneErrorThresholdScale, float LODBoneShellDistanceScale, acl::track_array_qvvf& ACLTracks)
+{
+	// A zero scale would collapse the virtual vertices of every bone missing from a LOD onto the bone itself
+	checkf(LODBoneShellDistanceScale > 0.0f, TEXT("The LOD bone shell distance scale must be positive: %f"), LODBoneShellDistanceScale);
+
+	TMap<FName, int32> BoneNumMissingLODsMap;
+	for (USkeletalMesh* OptimizationTarget : OptimizationTargets)
+	{
+		AppendNumMissingLODs(OptimizationTarget, BoneNumMissingLODsMap);
+	}
+
+	const uint32 NumBones = ACLTracks.get_num_tracks();
+
+	TArray<float> PrecisionScales;
+	PrecisionScales.Init(1.0f, NumBones);
+
+	for (uint32 ACLBoneIndex = 0; ACLBoneIndex < NumBones; ++ACLBoneIndex)
+	{
+		acl::track_qvvf& ACLTrack = ACLTracks[ACLBoneIndex];
+		const FName BoneName(ACLTrack.get_name().c_str());
+
+		const int32* NumMissingLODs = BoneNumMissingLODsMap.Find(BoneName);
+		if (NumMissingLODs == nullptr || *NumMissingLODs <= 0)
+		{
+			continue;	// Present in every LOD or unknown, use the default precision
+		}
+
+		// The further up a bone is removed, the looser it can be
+		PrecisionScales[ACLBoneIndex] = FMath::Pow(LODBoneErrorThresholdScale, float(*NumMissingLODs));
+
+		acl::track_desc_transformf& Desc = ACLTrack.get_description();
+		Desc.shell_distance *= FMath::Pow(LODBoneShellDistanceScale, float(*NumMissingLODs));
+	}
+
+	return PrecisionScales;
+}
+
+static void SetErrorThreshold(acl::track_array_qvvf& ACLTracks, float ErrorThreshold, const TArray<float>& PrecisionScales)
+{
+	const uint32 NumBones = ACLTracks.get_num_tracks();
+	for (uint32 ACLBoneIndex = 0; ACLBoneIndex < NumBones; ++ACLBoneIndex)
+	{
+		const float PrecisionScale = PrecisionScales.IsValidIndex(ACLBoneIndex) ? PrecisionScales[ACLBoneIndex] : 1.0f;
+		ACLTracks[ACLBoneIndex].get_description().precision = ErrorThreshold * PrecisionScale;
+	}
+}
+
+static uint32 GetMemoryBudget(const FCompressibleAnimData& CompressibleAnimData, ACLMemoryBudgetMode MemoryBudgetMode, int32 MemoryBudget)
+{
+	if (MemoryBudgetMode == ACLMBM_BytesPerSecond)
+	{
+		const float SequenceLength = FMath::Max(CompressibleAnimData.SequenceLength, MINIMUM_ANIMATION_LENGTH);
+		return (uint32)FMath::Max(FMath::CeilToInt(float(MemoryBudget) * SequenceLength), 1);
+	}
+
+	return (uint32)FMath::Max(MemoryBudget, 1);
+}
+
+/*
+ * Compresses the tracks multiple times to find the lowest error threshold whose compressed size fits within the memory budget.
+ * The compressed size decreases as the error threshold increases and we search between the two bounds in logarithmic space since
+ * thresholds commonly span several orders of magnitude. The track arrays are built once by the caller and only their precision
+ * changes between iterations.
+ */
+static acl::error_result CompressWithMemoryBudget(ACLAllocator& AllocatorImpl, acl::track_array_qvvf& ACLTracks, const TArray<float>& PrecisionScales, const acl::compression_settings& Settings, const acl::track_array_qvvf& ACLBaseTracks, acl::additive_clip_format8 AdditiveFormat,
+	uint32 MemoryBudget, float MinErrorThreshold, float MaxErrorThreshold, int32 MaxNumIterations,
+	acl::compressed_tracks*& OutCompressedTracks, acl::output_stats& OutStats, float& OutErrorThreshold)
+{
+	// Every attempt has its own stats, only the stats of the retained compressed data are returned
+	const acl::output_stats RequestedStats = OutStats;
+
+	// Attempts to compress with the provided threshold and returns whether or not the result fits within our budget
+	auto TryCompress = [&](float ErrorThreshold, acl::compressed_tracks*& OutAttempt, acl::output_stats& OutAttemptStats, acl::error_result& OutResult)
+	{
+		SetErrorThreshold(ACLTracks, ErrorThreshold, PrecisionScales);
+
+		OutAttempt = nullptr;
+		OutAttemptStats = RequestedStats;
+		OutResult = acl::compress_track_list(AllocatorImpl, ACLTracks, Settings, ACLBaseTracks, AdditiveFormat, OutAttempt, OutAttemptStats);
+		return OutResult.empty() && OutAttempt->get_size() <= MemoryBudget;
+	};
+
+	MaxErrorThreshold = FMath::Max(MaxErrorThreshold, MinErrorThreshold);
+
+	// Start with the best quality, it might already fit
+	acl::error_result Result;
+	if (TryCompress(MinErrorThreshold, OutCompressedTracks, OutStats, Result) || Result.any())
+	{
+		OutErrorThreshold = MinErrorThreshold;
+		return Result;
+	}
+
+	AllocatorImpl.deallocate(OutCompressedTracks, OutCompressedTracks->get_size());
+
+	// Then with the lowest quality, if it doesn't fit we can't do better than this
+	if (!TryCompress(MaxErrorThreshold, OutCompressedTracks, OutStats, Result))
+	{
+		if (Result.empty())
+		{
+			UE_LOG(LogAnimationCompression, Warning, TEXT("ACL Animation cannot fit within its memory budget of %u bytes, using the maximum error threshold: %u bytes"), MemoryBudget, OutCompressedTracks->get_size());
+		}
+
+		OutErrorThreshold = MaxErrorThreshold;
+		return Result;
+	}
+
+	// The lower bound never fits while the upper bound always fits and we retain its compressed data
+	float LowerErrorThreshold = MinErrorThreshold;
+	float UpperErrorThreshold = MaxErrorThreshold;
+
+	for (int32 Iteration = 2; Iteration < MaxNumIterations; ++Iteration)
+	{
+		if (UpperErrorThreshold - LowerErrorThreshold <= UpperErrorThreshold * 0.01f)
+		{
+			break;	// Within 1% of the best threshold, good enough
+		}
+
+		const float ErrorThreshold = LowerErrorThreshold > 0.0f ? FMath::Sqrt(LowerErrorThreshold * UpperErrorThreshold) : ((LowerErrorThreshold + UpperErrorThreshold) * 0.5f);
+
+		acl::compressed_tracks* Attempt = nullptr;
+		acl::output_stats AttemptStats;
+		if (TryCompress(ErrorThreshold, Attempt, AttemptStats, Result))
+		{
+			AllocatorImpl.deallocate(OutCompressedTracks, OutCompressedTracks->get_size());
+			OutCompressedTracks = Attempt;
+			OutStats = AttemptStats;
+			UpperErrorThreshold = ErrorThreshold;
+		}
+		else
+		{
+			if (Attempt != nullptr)
+			{
+				AllocatorImpl.deallocate(Attempt, Attempt->get_size());
+			}
+
+			LowerErrorThreshold = ErrorThreshold;
+		}
+	}
+
+	// Our tracks must reflect the precision used by the retained compressed data
+	SetErrorThreshold(ACLTracks, UpperErrorThreshold, PrecisionScales);
+
+	OutErrorThreshold = UpperErrorThreshold;
+	return acl::error_result();
+}
+
 bool UAnimBoneCompressionCodec_ACLBase::Compress(const FCompressibleAnimData& CompressibleAnimData, FCompressibleAnimDataResult& OutResult)
 {
 	ACLAllocator AllocatorImpl;
@@ -187,9 +611,23 @@ bool UAnimBoneCompressionCodec_ACLBase::Compress(const FCompressibleAnimData& Co
 		PopulateShellDistanceFromOptimizationTargets(CompressibleAnimData, OptimizationTargets, ACLTracks);
 	}
 
+	// Bones that nothing depends on only need their bind pose
+	if (ShouldStripUnusedBones() && OptimizationTargets.Num() != 0)
+	{
+		StripUnusedBones(CompressibleAnimData, OptimizationTargets, ACLTracks);
+	}
+
+	// Bones that are removed from the lower LODs use a looser precision
+	TArray<float> PrecisionScales;
+	float LODBoneErrorThresholdScale;
+	float LODBoneShellDistanceScale;
+	if (GetLODBonePrecision(LODBoneErrorThresholdScale, LODBoneShellDistanceScale) && OptimizationTargets.Num() != 0)
+	{
+		PrecisionScales = PopulateLODPrecisionFromOptimizationTargets(OptimizationTargets, LODBoneErrorThresholdScale, LODBoneShellDistanceScale, ACLTracks);
+	}
+
 	// Set our error threshold
-	for (acl::track_qvvf& Track : ACLTracks)
-		Track.get_description().precision = ErrorThreshold;
+	SetErrorThreshold(ACLTracks, ErrorThreshold, PrecisionScales);
 
 	// Override track settings if we need to
 	if (IsA<UAnimBoneCompressionCodec_ACLSafe>())
@@ -217,7 +655,20 @@ bool UAnimBoneCompressionCodec_ACLBase::Compress(const FCompressibleAnimData& Co
 
 	acl::output_stats Stats;
 	acl::compressed_tracks* CompressedTracks = nullptr;
-	acl::error_result CompressionResult = acl::compress_track_list(AllocatorImpl, ACLTracks, Settings, ACLBaseTracks, AdditiveFormat, CompressedTracks, Stats);
+	acl::error_result CompressionResult;
+	float UsedErrorThreshold = ErrorThreshold;
+
+	if (MemoryBudgetMode != ACLMBM_Disabled)
+	{
+		const uint32 SequenceMemoryBudget = GetMemoryBudget(CompressibleAnimData, MemoryBudgetMode, MemoryBudget);
+		CompressionResult = CompressWithMemoryBudget(AllocatorImpl, ACLTracks, PrecisionScales, Settings, ACLBaseTracks, AdditiveFormat, SequenceMemoryBudget, MinErrorThreshold, MaxErrorThreshold, MaxNumMemoryBudgetIterations, CompressedTracks, Stats, UsedErrorThreshold);
+
+		UE_LOG(LogAnimationCompression, Verbose, TEXT("ACL Animation memory budget: %u bytes, selected error threshold: %.4f cm"), SequenceMemoryBudget, UsedErrorThreshold);
+	}
+	else
+	{
+		CompressionResult = acl::compress_track_list(AllocatorImpl, ACLTracks, Settings, ACLBaseTracks, AdditiveFormat, CompressedTracks, Stats);
+	}
 
 	// Make sure if we managed to compress, that the error is acceptable and if it isn't, re-compress again with safer settings
 	// This should be VERY rare with the default threshold
@@ -243,15 +694,42 @@ bool UAnimBoneCompressionCodec_ACLBase::Compress(const FCompressibleAnimData& Co
 
 	const uint32 CompressedClipDataSize = CompressedTracks->get_size();
 
-	OutResult.CompressedByteStream.Empty(CompressedClipDataSize);
-	OutResult.CompressedByteStream.AddUninitialized(CompressedClipDataSize);
+	// When requested by the curve codec, the curves are stored right after the bone data in the same buffer
+	TArray<uint8> CompressedCurveBytes;
+	UAnimCurveCompressionCodec_ACL* CurveCodec = CompressibleAnimData.CurveCompressionSettings != nullptr ? Cast<UAnimCurveCompressionCodec_ACL>(CompressibleAnimData.CurveCompressionSettings->Codec) : nullptr;
+	if (CurveCodec != nullptr && CurveCodec->IsStoredWithBoneData(CompressibleAnimData))
+	{
+		if (!CurveCodec->CompressCurves(CompressibleAnimData, CompressedCurveBytes))
+		{
+			AllocatorImpl.deallocate(CompressedTracks, CompressedClipDataSize);
+			return false;
+		}
+	}
+
+	// ACL requires its data to be 16 byte aligned
+	const uint32 CompressedCurveOffset = CompressedCurveBytes.Num() != 0 ? Align(CompressedClipDataSize, 16) : 0;
+	const uint32 CompressedCurveSize = CompressedCurveBytes.Num();
+	const uint32 CompressedDataSize = CompressedCurveSize != 0 ? (CompressedCurveOffset + CompressedCurveSize) : CompressedClipDataSize;
+
+	OutResult.CompressedByteStream.Empty(CompressedDataSize);
+	OutResult.CompressedByteStream.AddZeroed(CompressedDataSize);
 	FMemory::Memcpy(OutResult.CompressedByteStream.GetData(), CompressedTracks, CompressedClipDataSize);
 
+	if (CompressedCurveSize != 0)
+	{
+		FMemory::Memcpy(OutResult.CompressedByteStream.GetData() + CompressedCurveOffset, CompressedCurveBytes.GetData(), CompressedCurveSize);
+	}
+
 	OutResult.Codec = this;
 
 	OutResult.AnimData = AllocateAnimData();
 	OutResult.AnimData->CompressedNumberOfFrames = CompressibleAnimData.NumFrames;
-	OutResult.AnimData->Bind(OutResult.CompressedByteStream);
+
+	FACLCompressedAnimData& ACLAnimData = static_cast<FACLCompressedAnimData&>(*OutResult.AnimData);
+	ACLAnimData.CompressedCurveOffset = CompressedCurveOffset;
+	ACLAnimData.CompressedCurveSize = CompressedCurveSize;
+	ACLAnimData.ErrorThreshold = UsedErrorThreshold;
+	ACLAnimData.Bind(OutResult.CompressedByteStream);
 
 #if !NO_LOGGING
 	{
@@ -272,11 +750,19 @@ void UAnimBoneCompressionCodec_ACLBase::PopulateDDCKey(FArchive& Ar)
 {
 	Super::PopulateDDCKey(Ar);
 
-	uint32 ForceRebuildVersion = 0;
+	uint32 ForceRebuildVersion = 2;
 
 	Ar << ForceRebuildVersion << DefaultVirtualVertexDistance << SafeVirtualVertexDistance << ErrorThreshold;
 	Ar << CompressionLevel;
 
+
+	// The selected error threshold is deterministic for a given set of search parameters
+	Ar << MemoryBudgetMode;
+	if (MemoryBudgetMode != ACLMBM_Disabled)
+	{
+		Ar << MemoryBudget << MinErrorThreshold << MaxErrorThreshold << MaxNumMemoryBudgetIterations;
+	}
+
 	// Add the end effector match name list since if it changes, we need to re-compress
 	const TArray<FString>& KeyEndEffectorsMatchNameArray = UAnimationSettings::Get()->KeyEndEffectorsMatchNameArray;
 	for (const FString& MatchName : KeyEndEffectorsMatchNameArray)
@@ -303,9 +789,15 @@ void UAnimBoneCompressionCodec_ACLBase::ByteSwapIn(ICompressedAnimData& AnimData
 #error "ACL does not currently support big-endian platforms"
 #endif
 
-	// TODO: ACL does not support byte swapping
+	// ACL data is little endian and consumed as-is, no swapping is required and we read it all at once.
+	// The bone and curve data share the same buffer. The engine loads the serialized bytes in a temporary
+	// array first and this copy into the compressed byte stream can't be avoided from the codec.
+	MemoryStream.Serialize(CompressedData.GetData(), CompressedData.Num());
+
+	// The data was bound before it was populated, it is validated only once now that the bytes are in place
 	FACLCompressedAnimData& ACLAnimData = static_cast<FACLCompressedAnimData&>(AnimData);
-	MemoryStream.Serialize(ACLAnimData.CompressedByteStream.GetData(), ACLAnimData.CompressedByteStream.Num());
+	ACLAnimData.bIsLoadingBulkData = false;
+	ACLAnimData.Validate();
 }
 
 void UAnimBoneCompressionCodec_ACLBase::ByteSwapOut(ICompressedAnimData& AnimData, TArrayView<uint8> CompressedData, FMemoryWriter& MemoryStream) const
@@ -314,7 +806,7 @@ void UAnimBoneCompressionCodec_ACLBase::ByteSwapOut(ICompressedAnimData& AnimDat
 #error "ACL does not currently support big-endian platforms"
 #endif
 
-	// TODO: ACL does not support byte swapping
-	FACLCompressedAnimData& ACLAnimData = static_cast<FACLCompressedAnimData&>(AnimData);
-	MemoryStream.Serialize(ACLAnimData.CompressedByteStream.GetData(), ACLAnimData.CompressedByteStream.Num());
+	// ACL data is little endian and written as-is
+	// The bone and curve data share the same buffer.
+	MemoryStream.Serialize(CompressedData.GetData(), CompressedData.Num());
 }
@@ -3,6 +3,7 @@
 #include "AnimBoneCompressionCodec_ACLCustom.h"
 
 #include "ACLDecompressionImpl.h"
+#include "ACLDecompressionKernels.h"
 
 #if WITH_EDITORONLY_DATA
 #include "Rendering/SkeletalMeshModel.h"
@@ -24,6 +25,11 @@ UAnimBoneCompressionCodec_ACLCustom::UAnimBoneCompressionCodec_ACLCustom(const F
 
 	IdealNumKeyFramesPerSegment = 16;
 	MaxNumKeyFramesPerSegment = 31;
+
+	bStripUnusedBones = false;
+	bUseLODBonePrecision = false;
+	LODBoneErrorThresholdScale = 2.0f;
+	LODBoneShellDistanceScale = 0.5f;
 #endif	// WITH_EDITORONLY_DATA
 }
 
@@ -42,6 +48,13 @@ void UAnimBoneCompressionCodec_ACLCustom::GetCompressionSettings(acl::compressio
 	OutSettings.segmenting.max_num_samples = MaxNumKeyFramesPerSegment;
 }
 
+bool UAnimBoneCompressionCodec_ACLCustom::GetLODBonePrecision(float& OutErrorThresholdScale, float& OutShellDistanceScale) const
+{
+	OutErrorThresholdScale = LODBoneErrorThresholdScale;
+	OutShellDistanceScale = LODBoneShellDistanceScale;
+	return bUseLODBonePrecision;
+}
+
 void UAnimBoneCompressionCodec_ACLCustom::PopulateDDCKey(FArchive& Ar)
 {
 	Super::PopulateDDCKey(Ar);
@@ -62,15 +75,58 @@ void UAnimBoneCompressionCodec_ACLCustom::PopulateDDCKey(FArchive& Ar)
 			Ar << MeshModel->SkeletalMeshModelGUID;
 		}
 	}
+
+	Ar << bStripUnusedBones;
+	if (bStripUnusedBones)
+	{
+		PopulateSocketBonesDDCKey(Ar, OptimizationTargets);
+	}
+
+	Ar << bUseLODBonePrecision;
+	if (bUseLODBonePrecision)
+	{
+		Ar << LODBoneErrorThresholdScale << LODBoneShellDistanceScale;
+	}
 }
 #endif // WITH_EDITORONLY_DATA
 
+#if WITH_EDITOR
+TUniquePtr<ICompressedAnimData> UAnimBoneCompressionCodec_ACLCustom::AllocateAnimData() const
+{
+	TUniquePtr<ICompressedAnimData> AnimData = Super::AllocateAnimData();
+
+	// Only our data is decoded with the format manifest, the other ACL codecs must not widen it when cooked
+	static_cast<FACLCompressedAnimData&>(*AnimData).bRecordFormatUsage = true;
+
+	return AnimData;
+}
+#endif
+
 void UAnimBoneCompressionCodec_ACLCustom::DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms) const
 {
-	::DecompressPose<UE4CustomDecompressionSettings>(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+#if ACL_WITH_FORMAT_MANIFEST
+	if (static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData).bIsSupportedByFormatManifest)
+	{
+		GACLDecompressionKernels.Manifest.DecompressPose(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+	}
+	else
+#endif
+	{
+		// The data uses a format missing from the manifest or we have no manifest, use the generic decoder
+		GACLDecompressionKernels.Custom.DecompressPose(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+	}
 }
 
 void UAnimBoneCompressionCodec_ACLCustom::DecompressBone(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom) const
 {
-	::DecompressBone<UE4CustomDecompressionSettings>(DecompContext, TrackIndex, OutAtom);
+#if ACL_WITH_FORMAT_MANIFEST
+	if (static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData).bIsSupportedByFormatManifest)
+	{
+		GACLDecompressionKernels.Manifest.DecompressBone(DecompContext, TrackIndex, OutAtom);
+	}
+	else
+#endif
+	{
+		GACLDecompressionKernels.Custom.DecompressBone(DecompContext, TrackIndex, OutAtom);
+	}
 }
@@ -3,6 +3,7 @@
 #include "AnimBoneCompressionCodec_ACLSafe.h"
 
 #include "ACLDecompressionImpl.h"
+#include "ACLDecompressionKernels.h"
 
 #if WITH_EDITORONLY_DATA
 #include <acl/compression/compression_settings.h>
@@ -39,10 +40,10 @@ void UAnimBoneCompressionCodec_ACLSafe::PopulateDDCKey(FArchive& Ar)
 
 void UAnimBoneCompressionCodec_ACLSafe::DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms) const
 {
-	::DecompressPose<UE4SafeDecompressionSettings>(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+	GACLDecompressionKernels.Safe.DecompressPose(DecompContext, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
 }
 
 void UAnimBoneCompressionCodec_ACLSafe::DecompressBone(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom) const
 {
-	::DecompressBone<UE4SafeDecompressionSettings>(DecompContext, TrackIndex, OutAtom);
+	GACLDecompressionKernels.Safe.DecompressBone(DecompContext, TrackIndex, OutAtom);
 }
@@ -1,9 +1,12 @@
 // Copyright 2020 Nicholas Frechette. All Rights Reserved.
 
 #include "AnimCurveCompressionCodec_ACL.h"
+#include "AnimBoneCompressionCodec_ACL.h"
 
 #if WITH_EDITORONLY_DATA
+#include "Animation/AnimBoneCompressionSettings.h"
 #include "Animation/MorphTarget.h"
+#include "Async/ParallelFor.h"
 #include "Rendering/SkeletalMeshModel.h"
 
 #include <acl/compression/compress.h>
@@ -14,7 +17,23 @@
 #include "ACLImpl.h"
 #endif	// WITH_EDITOR
 
-#include <acl/decompression/decompress.h>
+#include "ACLDecompressionImpl.h"
+
+/*
+ * When the curves are stored with the bone data, the engine curve stream only holds this header.
+ * The engine considers the curves of a sequence missing when its curve stream is empty and falls back
+ * to the raw curves or to nothing at all, the header keeps it non-empty and points to the bone data.
+ * It can't be mistaken for ACL compressed tracks since those start with their size which is much larger.
+ */
+struct FACLSharedCurveStreamHeader
+{
+	static constexpr uint32 SharedTag = 0x42434341;	// 'ACCB'
+
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Tag;
+	uint32 Version;
+};
 
 UAnimCurveCompressionCodec_ACL::UAnimCurveCompressionCodec_ACL(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -22,6 +41,7 @@ UAnimCurveCompressionCodec_ACL::UAnimCurveCompressionCodec_ACL(const FObjectInit
 #if WITH_EDITORONLY_DATA
 	CurvePrecision = 0.001f;
 	MorphTargetPositionPrecision = 0.01f;		// 0.01cm, conservative enough for cinematographic quality
+	bStoreWithBoneData = false;
 #endif
 }
 
@@ -32,6 +52,7 @@ void UAnimCurveCompressionCodec_ACL::PopulateDDCKey(FArchive& Ar)
 
 	Ar << CurvePrecision;
 	Ar << MorphTargetPositionPrecision;
+	Ar << bStoreWithBoneData;
 
 	if (MorphTargetSource != nullptr)
 	{
@@ -42,16 +63,95 @@ void UAnimCurveCompressionCodec_ACL::PopulateDDCKey(FArchive& Ar)
 		}
 	}
 
-	uint32 ForceRebuildVersion = 1;
+	uint32 ForceRebuildVersion = 2;
 	Ar << ForceRebuildVersion;
 
 	acl::compression_settings Settings;
+	GetCompressionSettings(Settings);
+
 	uint32 SettingsHash = Settings.get_hash();
 	Ar << SettingsHash;
 }
 
+void UAnimCurveCompressionCodec_ACL::GetCompressionSettings(acl::compression_settings& OutSettings) const
+{
+	OutSettings = acl::compression_settings();
+}
+
+// Returns the largest position delta of a morph target in LOD0
+static float CalculateMorphTargetMaxPositionDelta(UMorphTarget& Target)
+{
+	const int32 LODIndex = 0;
+	int32 NumDeltas = 0;
+	const FMorphTargetDelta* Deltas = Target.GetMorphTargetDelta(LODIndex, NumDeltas);
+
+	// Track the squared length with a few independent accumulators and only take a single square root at the end
+	VectorRegister MaxDeltaLengthSq0 = VectorZero();
+	VectorRegister MaxDeltaLengthSq1 = VectorZero();
+
+	int32 DeltaIndex = 0;
+	for (; DeltaIndex + 1 < NumDeltas; DeltaIndex += 2)
+	{
+		const VectorRegister Delta0 = VectorLoadFloat3(&Deltas[DeltaIndex + 0].PositionDelta);
+		const VectorRegister Delta1 = VectorLoadFloat3(&Deltas[DeltaIndex + 1].PositionDelta);
+
+		MaxDeltaLengthSq0 = VectorMax(MaxDeltaLengthSq0, VectorDot3(Delta0, Delta0));
+		MaxDeltaLengthSq1 = VectorMax(MaxDeltaLengthSq1, VectorDot3(Delta1, Delta1));
+	}
+
+	if (DeltaIndex < NumDeltas)
+	{
+		const VectorRegister Delta0 = VectorLoadFloat3(&Deltas[DeltaIndex].PositionDelta);
+		MaxDeltaLengthSq0 = VectorMax(MaxDeltaLengthSq0, VectorDot3(Delta0, Delta0));
+	}
+
+	float MaxDeltaLengthSq;
+	VectorStoreFloat1(VectorMax(MaxDeltaLengthSq0, MaxDeltaLengthSq1), &MaxDeltaLengthSq);
+
+	return FMath::Sqrt(MaxDeltaLengthSq);
+}
+
+// Returns the largest position delta of every morph target of a mesh, the results are cached per mesh model
+static TMap<FName, float> GetMorphTargetMaxPositionDeltaMap(USkeletalMesh& MorphTargetSource)
+{
+	static FCriticalSection CacheLock;
+	static TMap<FGuid, TMap<FName, float>> Cache;
+
+	// The model GUID changes whenever the mesh is re-imported or edited
+	const FSkeletalMeshModel* MeshModel = MorphTargetSource.GetImportedModel();
+	const FGuid MeshModelGUID = MeshModel != nullptr ? MeshModel->SkeletalMeshModelGUID : FGuid();
+
+	if (MeshModelGUID.IsValid())
+	{
+		FScopeLock Lock(&CacheLock);
+
+		const TMap<FName, float>* CachedMaxPositionDeltas = Cache.Find(MeshModelGUID);
+		if (CachedMaxPositionDeltas != nullptr)
+		{
+			return *CachedMaxPositionDeltas;
+		}
+	}
+
+	TMap<FName, float> MaxPositionDeltas;
+	for (UMorphTarget* Target : MorphTargetSource.MorphTargets)
+	{
+		if (Target != nullptr)
+		{
+			MaxPositionDeltas.Add(Target->GetFName(), CalculateMorphTargetMaxPositionDelta(*Target));
+		}
+	}
+
+	if (MeshModelGUID.IsValid())
+	{
+		FScopeLock Lock(&CacheLock);
+		Cache.Add(MeshModelGUID, MaxPositionDeltas);
+	}
+
+	return MaxPositionDeltas;
+}
+
 // For each curve, returns its largest position delta if the curve is for a morph target, 0.0 otherwise
-static TArray<float> GetMorphTargetMaxPositionDeltas(const FCompressibleAnimData& AnimSeq, const USkeletalMesh* MorphTargetSource)
+static TArray<float> GetMorphTargetMaxPositionDeltas(const FCompressibleAnimData& AnimSeq, USkeletalMesh* MorphTargetSource)
 {
 	const int32 NumCurves = AnimSeq.RawCurveData.FloatCurves.Num();
 
@@ -63,32 +163,118 @@ static TArray<float> GetMorphTargetMaxPositionDeltas(const FCompressibleAnimData
 		return MorphTargetMaxPositionDeltas;
 	}
 
+	const TMap<FName, float> MaxPositionDeltaMap = GetMorphTargetMaxPositionDeltaMap(*MorphTargetSource);
+
 	for (int32 CurveIndex = 0; CurveIndex < NumCurves; ++CurveIndex)
 	{
-		float MaxDeltaPosition = 0.0f;
-
 		const FFloatCurve& Curve = AnimSeq.RawCurveData.FloatCurves[CurveIndex];
-		UMorphTarget* Target = MorphTargetSource->FindMorphTarget(Curve.Name.DisplayName);
-		if (Target != nullptr)
+
+		// Curves that don't drive a morph target have no delta
+		const float* MaxPositionDelta = MaxPositionDeltaMap.Find(Curve.Name.DisplayName);
+		MorphTargetMaxPositionDeltas[CurveIndex] = MaxPositionDelta != nullptr ? *MaxPositionDelta : 0.0f;
+	}
+
+	return MorphTargetMaxPositionDeltas;
+}
+
+/*
+* Evaluates a rich curve at monotonically increasing sample times.
+* FRichCurve::Eval performs a binary search over the keys for every sample, here we instead
+* walk the keys as the sample time increases which makes sampling a whole curve linear.
+* Interior segments are evaluated exactly like FRichCurve::EvalForTwoKeys, anything else
+* (extrapolation, weighted tangents) falls back to FRichCurve::Eval.
+*/
+class FSequentialRichCurveEvaluator
+{
+public:
+	explicit FSequentialRichCurveEvaluator(const FRichCurve& Curve_)
+		: Curve(Curve_)
+		, Keys(Curve_.GetConstRefOfKeys())
+		, KeyIndex(1)
+	{}
+
+	// Sample times must be provided in increasing order
+	float Eval(float SampleTime)
+	{
+		const int32 NumKeys = Keys.Num();
+		if (NumKeys < 2 || SampleTime <= Keys[0].Time || SampleTime >= Keys[NumKeys - 1].Time)
+		{
+			return Curve.Eval(SampleTime);	// Extrapolation or static curve
+		}
+
+		// Find the first key past our sample time, this matches the binary search in FRichCurve::Eval
+		while (Keys[KeyIndex].Time <= SampleTime)
 		{
-			// This curve drives a morph target, find the largest displacement it can have
-			const int32 LODIndex = 0;
-			int32 NumDeltas = 0;
-			const FMorphTargetDelta* Deltas = Target->GetMorphTargetDelta(LODIndex, NumDeltas);
-			for (int32 DeltaIndex = 0; DeltaIndex < NumDeltas; ++DeltaIndex)
-			{
-				const FMorphTargetDelta& Delta = Deltas[DeltaIndex];
-				MaxDeltaPosition = FMath::Max(MaxDeltaPosition, Delta.PositionDelta.Size());
-			}
+			KeyIndex++;
 		}
 
-		MorphTargetMaxPositionDeltas[CurveIndex] = MaxDeltaPosition;
+		const FRichCurveKey& Key1 = Keys[KeyIndex - 1];
+		const FRichCurveKey& Key2 = Keys[KeyIndex];
+
+		const float Diff = Key2.Time - Key1.Time;
+		if (Diff <= 0.0f || Key1.InterpMode == RCIM_Constant)
+		{
+			return Key1.Value;
+		}
+
+		const float Alpha = (SampleTime - Key1.Time) / Diff;
+		const float P0 = Key1.Value;
+		const float P3 = Key2.Value;
+
+		if (Key1.InterpMode == RCIM_Linear)
+		{
+			return FMath::Lerp(P0, P3, Alpha);
+		}
+
+		// Same predicate as the engine, only the tangent weight modes matter regardless of the interpolation of the second key
+		const bool bIsWeighted = (Key1.TangentWeightMode == RCTWM_WeightedLeave || Key1.TangentWeightMode == RCTWM_WeightedBoth)
+			|| (Key2.TangentWeightMode == RCTWM_WeightedArrive || Key2.TangentWeightMode == RCTWM_WeightedBoth);
+		if (bIsWeighted)
+		{
+			return Curve.Eval(SampleTime);	// Rare, let the curve solve the weighted tangents
+		}
+
+		const float OneThird = 1.0f / 3.0f;
+		const float P1 = P0 + (Key1.LeaveTangent * Diff * OneThird);
+		const float P2 = P3 - (Key2.ArriveTangent * Diff * OneThird);
+
+		// Same De Casteljau evaluation as the engine to produce identical samples
+		const float P01 = FMath::Lerp(P0, P1, Alpha);
+		const float P12 = FMath::Lerp(P1, P2, Alpha);
+		const float P23 = FMath::Lerp(P2, P3, Alpha);
+		const float P012 = FMath::Lerp(P01, P12, Alpha);
+		const float P123 = FMath::Lerp(P12, P23, Alpha);
+		return FMath::Lerp(P012, P123, Alpha);
 	}
 
-	return MorphTargetMaxPositionDeltas;
+private:
+	const FRichCurve& Curve;
+	const TArray<FRichCurveKey>& Keys;
+	int32 KeyIndex;
+};
+
+#if DO_GUARD_SLOW
+// Makes sure the sequential evaluation matches FRichCurve::Eval on every key and in the middle of every segment
+static void VerifySequentialRichCurveEvaluator(const FRichCurve& Curve)
+{
+	const TArray<FRichCurveKey>& Keys = Curve.GetConstRefOfKeys();
+	FSequentialRichCurveEvaluator CurveEvaluator(Curve);
+
+	for (int32 KeyIndex = 0; KeyIndex < Keys.Num(); ++KeyIndex)
+	{
+		const float KeyTime = Keys[KeyIndex].Time;
+		checkfSlow(CurveEvaluator.Eval(KeyTime) == Curve.Eval(KeyTime), TEXT("Sequential curve evaluation mismatch at key %d"), KeyIndex);
+
+		if (KeyIndex + 1 < Keys.Num())
+		{
+			const float MidTime = (KeyTime + Keys[KeyIndex + 1].Time) * 0.5f;
+			checkfSlow(CurveEvaluator.Eval(MidTime) == Curve.Eval(MidTime), TEXT("Sequential curve evaluation mismatch after key %d"), KeyIndex);
+		}
+	}
 }
+#endif
 
-bool UAnimCurveCompressionCodec_ACL::Compress(const FCompressibleAnimData& AnimSeq, FAnimCurveCompressionResult& OutResult)
+bool UAnimCurveCompressionCodec_ACL::CompressCurves(const FCompressibleAnimData& AnimSeq, TArray<uint8>& OutCompressedBytes) const
 {
 	const TArray<float> MorphTargetMaxPositionDeltas = GetMorphTargetMaxPositionDeltas(AnimSeq, MorphTargetSource);
 
@@ -96,8 +282,7 @@ bool UAnimCurveCompressionCodec_ACL::Compress(const FCompressibleAnimData& AnimS
 	if (NumCurves == 0)
 	{
 		// Nothing to compress
-		OutResult.CompressedBytes.Empty(0);
-		OutResult.Codec = this;
+		OutCompressedBytes.Empty(0);
 		return true;
 	}
 
@@ -111,7 +296,8 @@ bool UAnimCurveCompressionCodec_ACL::Compress(const FCompressibleAnimData& AnimS
 	ACLAllocator AllocatorImpl;
 	acl::track_array_float1f Tracks(AllocatorImpl, NumCurves);
 
-	for (int32 CurveIndex = 0; CurveIndex < NumCurves; ++CurveIndex)
+	// Curves are independent, long takes with many curves benefit from sampling them in parallel
+	ParallelFor(NumCurves, [&](int32 CurveIndex)
 	{
 		const FFloatCurve& Curve = AnimSeq.RawCurveData.FloatCurves[CurveIndex];
 		const float MaxPositionDelta = MorphTargetMaxPositionDeltas[CurveIndex];
@@ -149,19 +335,27 @@ bool UAnimCurveCompressionCodec_ACL::Compress(const FCompressibleAnimData& AnimS
 		Desc.output_index = CurveIndex;
 		Desc.precision = Precision;
 
+#if DO_GUARD_SLOW
+		VerifySequentialRichCurveEvaluator(Curve.FloatCurve);
+#endif
+
+		FSequentialRichCurveEvaluator CurveEvaluator(Curve.FloatCurve);
+
 		acl::track_float1f Track = acl::track_float1f::make_reserve(Desc, AllocatorImpl, NumSamples, SampleRate);
 		for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
 		{
 			const float SampleTime = FMath::Clamp(SampleIndex * InvSampleRate, 0.0f, SequenceLength);
-			const float SampleValue = Curve.FloatCurve.Eval(SampleTime);
+			const float SampleValue = CurveEvaluator.Eval(SampleTime);
+			checkSlow(SampleValue == Curve.FloatCurve.Eval(SampleTime));
 
 			Track[SampleIndex] = SampleValue;
 		}
 
 		Tracks[CurveIndex] = MoveTemp(Track);
-	}
+	});
 
 	acl::compression_settings Settings;
+	GetCompressionSettings(Settings);
 
 	acl::compressed_tracks* CompressedTracks = nullptr;
 	acl::output_stats Stats;
@@ -177,11 +371,9 @@ bool UAnimCurveCompressionCodec_ACL::Compress(const FCompressibleAnimData& AnimS
 
 	const uint32 CompressedDataSize = CompressedTracks->get_size();
 
-	OutResult.CompressedBytes.Empty(CompressedDataSize);
-	OutResult.CompressedBytes.AddUninitialized(CompressedDataSize);
-	FMemory::Memcpy(OutResult.CompressedBytes.GetData(), CompressedTracks, CompressedDataSize);
-
-	OutResult.Codec = this;
+	OutCompressedBytes.Empty(CompressedDataSize);
+	OutCompressedBytes.AddUninitialized(CompressedDataSize);
+	FMemory::Memcpy(OutCompressedBytes.GetData(), CompressedTracks, CompressedDataSize);
 
 #if !NO_LOGGING
 	{
@@ -197,33 +389,78 @@ bool UAnimCurveCompressionCodec_ACL::Compress(const FCompressibleAnimData& AnimS
 	AllocatorImpl.deallocate(CompressedTracks, CompressedDataSize);
 	return true;
 }
-#endif // WITH_EDITORONLY_DATA
 
-struct UE4CurveDecompressionSettings final : public acl::decompression_settings
+bool UAnimCurveCompressionCodec_ACL::IsStoredWithBoneData(const FCompressibleAnimData& AnimSeq) const
 {
-	static constexpr bool is_track_type_supported(acl::track_type8 type) { return type == acl::track_type8::float1f; }
-};
+	if (!bStoreWithBoneData || AnimSeq.RawCurveData.FloatCurves.Num() == 0 || AnimSeq.BoneCompressionSettings == nullptr)
+	{
+		return false;
+	}
+
+	// Every bone codec that can be selected must be able to store our curves
+	for (const UAnimBoneCompressionCodec* BoneCodec : AnimSeq.BoneCompressionSettings->Codecs)
+	{
+		if (BoneCodec == nullptr || !BoneCodec->IsA<UAnimBoneCompressionCodec_ACLBase>())
+		{
+			return false;
+		}
+
+		const UAnimBoneCompressionCodec_ACL* ACLCodec = Cast<UAnimBoneCompressionCodec_ACL>(BoneCodec);
+		if (ACLCodec != nullptr && ACLCodec->SafetyFallbackCodec != nullptr && !ACLCodec->SafetyFallbackCodec->IsA<UAnimBoneCompressionCodec_ACLBase>())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
 
-struct UE4CurveWriter final : public acl::track_writer
+bool UAnimCurveCompressionCodec_ACL::Compress(const FCompressibleAnimData& AnimSeq, FAnimCurveCompressionResult& OutResult)
 {
-	const TArray<FSmartName>& CompressedCurveNames;
-	FBlendedCurve& Curves;
+	OutResult.Codec = this;
 
-	UE4CurveWriter(const TArray<FSmartName>& CompressedCurveNames_, FBlendedCurve& Curves_)
-		: CompressedCurveNames(CompressedCurveNames_)
-		, Curves(Curves_)
+	if (!IsStoredWithBoneData(AnimSeq))
 	{
+		return CompressCurves(AnimSeq, OutResult.CompressedBytes);
 	}
 
-	void write_float1(uint32_t TrackIndex, rtm::scalarf_arg0 Value)
+	// The bone codec compresses and stores our curves, we only write the header that points to them
+	FACLSharedCurveStreamHeader Header;
+	Header.Tag = FACLSharedCurveStreamHeader::SharedTag;
+	Header.Version = FACLSharedCurveStreamHeader::CurrentVersion;
+
+	OutResult.CompressedBytes.Empty(sizeof(Header));
+	OutResult.CompressedBytes.Append(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	return true;
+}
+#endif // WITH_EDITORONLY_DATA
+
+// Returns the compressed curves, either from their own stream or from the bone data they are stored with
+static const uint8* GetCompressedCurveData(const FCompressedAnimSequence& AnimSeq)
+{
+	const TArray<uint8>& CurveStream = AnimSeq.CompressedCurveByteStream;
+	if (CurveStream.Num() != sizeof(FACLSharedCurveStreamHeader))
 	{
-		const FSmartName& CurveName = CompressedCurveNames[TrackIndex];
-		if (Curves.IsEnabled(CurveName.UID))
+		return CurveStream.Num() != 0 ? CurveStream.GetData() : nullptr;
+	}
+
+	FACLSharedCurveStreamHeader Header;
+	FMemory::Memcpy(&Header, CurveStream.GetData(), sizeof(Header));
+	check(Header.Tag == FACLSharedCurveStreamHeader::SharedTag && Header.Version == FACLSharedCurveStreamHeader::CurrentVersion);
+
+	if (AnimSeq.CompressedDataStructure.IsValid() && AnimSeq.BoneCompressionCodec != nullptr && AnimSeq.BoneCompressionCodec->IsA<UAnimBoneCompressionCodec_ACLBase>())
+	{
+		const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(*AnimSeq.CompressedDataStructure);
+		if (AnimData.bIsCurveDataValid)
 		{
-			Curves.Set(CurveName.UID, rtm::scalar_cast(Value));
+			return AnimData.CompressedCurveByteStream.GetData();
 		}
 	}
-};
+
+	// Both streams come from the same compression result, the bone data must hold our curves
+	ensureMsgf(false, TEXT("ACL curves are stored with the bone data but the bone data doesn't contain valid curves"));
+	return nullptr;
+}
 
 void UAnimCurveCompressionCodec_ACL::DecompressCurves(const FCompressedAnimSequence& AnimSeq, FBlendedCurve& Curves, float CurrentTime) const
 {
@@ -235,8 +472,15 @@ void UAnimCurveCompressionCodec_ACL::DecompressCurves(const FCompressedAnimSeque
 		return;
 	}
 
-	const acl::compressed_tracks* CompressedTracks = acl::make_compressed_tracks(AnimSeq.CompressedCurveByteStream.GetData());
-	check(CompressedTracks != nullptr && CompressedTracks->is_valid(false).empty());
+	const uint8* CompressedCurveData = GetCompressedCurveData(AnimSeq);
+	if (CompressedCurveData == nullptr)
+	{
+		return;
+	}
+
+	const acl::compressed_tracks* CompressedTracks = acl::make_compressed_tracks(CompressedCurveData);
+	// The curves are validated when compressed, only double check in debug builds
+	checkSlow(CompressedTracks != nullptr && CompressedTracks->is_valid(false).empty());
 
 	acl::decompression_context<UE4CurveDecompressionSettings> Context;
 	Context.initialize(*CompressedTracks);
@@ -271,8 +515,15 @@ float UAnimCurveCompressionCodec_ACL::DecompressCurve(const FCompressedAnimSeque
 		return 0.0f;
 	}
 
-	const acl::compressed_tracks* CompressedTracks = acl::make_compressed_tracks(AnimSeq.CompressedCurveByteStream.GetData());
-	check(CompressedTracks != nullptr && CompressedTracks->is_valid(false).empty());
+	const uint8* CompressedCurveData = GetCompressedCurveData(AnimSeq);
+	if (CompressedCurveData == nullptr)
+	{
+		return 0.0f;
+	}
+
+	const acl::compressed_tracks* CompressedTracks = acl::make_compressed_tracks(CompressedCurveData);
+	// The curves are validated when compressed, only double check in debug builds
+	checkSlow(CompressedTracks != nullptr && CompressedTracks->is_valid(false).empty());
 
 	acl::decompression_context<UE4CurveDecompressionSettings> Context;
 	Context.initialize(*CompressedTracks);
@@ -0,0 +1,32 @@
+// Copyright 2020 Nicholas Frechette. All Rights Reserved.
+
+#include "AnimCurveCompressionCodec_ACLCustom.h"
+
+#if WITH_EDITORONLY_DATA
+#include "ACLImpl.h"
+#endif
+
+UAnimCurveCompressionCodec_ACLCustom::UAnimCurveCompressionCodec_ACLCustom(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+#if WITH_EDITORONLY_DATA
+	CompressionLevel = ACLCL_Medium;
+#endif	// WITH_EDITORONLY_DATA
+}
+
+#if WITH_EDITORONLY_DATA
+void UAnimCurveCompressionCodec_ACLCustom::GetCompressionSettings(acl::compression_settings& OutSettings) const
+{
+	OutSettings = acl::compression_settings();
+	OutSettings.level = GetCompressionLevel(CompressionLevel);
+}
+
+void UAnimCurveCompressionCodec_ACLCustom::PopulateDDCKey(FArchive& Ar)
+{
+	// Our parent hashes the compression settings, the compression level is added explicitly so the key doesn't depend on what ACL hashes
+	Super::PopulateDDCKey(Ar);
+
+	uint32 ForceRebuildVersion = 2;
+	Ar << ForceRebuildVersion << CompressionLevel;
+}
+#endif // WITH_EDITORONLY_DATA
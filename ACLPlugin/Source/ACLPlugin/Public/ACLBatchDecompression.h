@@ -0,0 +1,55 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "AnimEncoding.h"
+#include "ACLDecompressionQuality.h"
+
+class UAnimSequence;
+struct FBlendedCurve;
+
+/** A single pose to decompress as part of a batch. */
+struct FACLPoseDecompressionRequest
+{
+	/** The anim sequence to sample, it must have valid compressed data. */
+	const UAnimSequence* AnimSeq = nullptr;
+
+	/** The time in seconds to sample the pose at. */
+	float Time = 0.0f;
+
+	/** The tracks to decompress and the atoms they are written to, like with UAnimBoneCompressionCodec::DecompressPose. */
+	const BoneTrackArray* RotationPairs = nullptr;
+	const BoneTrackArray* TranslationPairs = nullptr;
+	const BoneTrackArray* ScalePairs = nullptr;
+
+	/** The quality to decompress the pose with, distant instances can trade accuracy for speed. */
+	EACLDecompressionQuality Quality = EACLDecompressionQuality::Full;
+
+	/** The output pose, every request must write to its own pose. */
+	TArrayView<FTransform> OutAtoms;
+
+	/** The output curves, optional. When provided, the curves are decompressed right after the pose. */
+	FBlendedCurve* OutCurves = nullptr;
+};
+
+/*
+ * Decompresses a pose and, when requested, the curves of an anim sequence in a single call.
+ * When the ACL curves are stored with the bone data, they are decoded right after the pose from the same
+ * buffer while it is still in the cache. ACL needs a decompression context per compressed stream and as
+ * such, the curves are still seeked on their own but that seek only touches their small header.
+ */
+ACLPLUGIN_API void DecompressPoseAndCurves(const FACLPoseDecompressionRequest& Request);
+
+/*
+ * Decompresses many poses at once, typically one per animated instance.
+ *
+ * Requests are sorted by anim sequence and by ACL segment so that the compressed data and the
+ * segment data stay hot in the cache while consecutive poses are decoded. The sorted requests are
+ * then split into small tasks that worker threads pick up as they become idle which balances
+ * the load when some sequences are much more expensive to decode than others.
+ *
+ * This function blocks until every pose has been decompressed. The requests can use any codec,
+ * the ones that don't use ACL are simply sorted by anim sequence and time.
+ */
+ACLPLUGIN_API void DecompressPoseBatch(TArrayView<const FACLPoseDecompressionRequest> Requests, int32 NumRequestsPerTask = 8);
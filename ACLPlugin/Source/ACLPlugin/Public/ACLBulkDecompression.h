@@ -0,0 +1,64 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+class UAnimSequence;
+
+/*
+ * Every sample of a range of frames of an ACL compressed anim sequence, stored as a structure of arrays.
+ * Values are stored frame after frame, each frame holds one value per track in track order:
+ * the value of a track at a frame is at index (FrameIndex - FirstFrame) * NumTracks + TrackIndex.
+ */
+struct FACLDecompressedClip
+{
+	/** The number of transform tracks, they match the compressed tracks of the anim sequence. */
+	int32 NumTracks = 0;
+
+	/** The first decompressed frame and how many frames were decompressed. */
+	int32 FirstFrame = 0;
+	int32 NumFrames = 0;
+
+	/** The rate at which the anim sequence is sampled, in frames per second. */
+	float SampleRate = 0.0f;
+
+	TArray<FQuat> Rotations;
+	TArray<FVector> Translations;
+
+	/** Empty when the anim sequence has no scale. */
+	TArray<FVector> Scales;
+
+	bool HasScale() const { return Scales.Num() != 0; }
+
+	FORCEINLINE int32 GetIndex(int32 FrameIndex, int32 TrackIndex) const { return (FrameIndex - FirstFrame) * NumTracks + TrackIndex; }
+
+	FTransform GetTransform(int32 FrameIndex, int32 TrackIndex) const
+	{
+		const int32 Index = GetIndex(FrameIndex, TrackIndex);
+		return FTransform(Rotations[Index], Translations[Index], HasScale() ? Scales[Index] : FVector::OneVector);
+	}
+};
+
+/*
+ * Decompresses every frame of an anim sequence, or of a range of its frames, into a structure of arrays.
+ * This is much faster than sampling one pose at a time to bake, retarget, mirror, or build databases:
+ * frames are read in order, segment by segment, and every sample is decoded without interpolation.
+ * Segments can optionally be decompressed in parallel.
+ *
+ * Returns false if the anim sequence isn't compressed with ACL. A NumFrames of INDEX_NONE decompresses up to the last frame.
+ */
+ACLPLUGIN_API bool DecompressClip(const UAnimSequence& AnimSeq, FACLDecompressedClip& OutClip, int32 FirstFrame = 0, int32 NumFrames = INDEX_NONE, bool bParallel = false);
+
+/*
+ * Decompresses a subset of the bones of an anim sequence for every frame of a range, typically to extract
+ * motion matching features. The decompression context is initialized once per range and every frame is decoded
+ * in a single pass over the compressed data, skipping the tracks that aren't needed.
+ *
+ * The output clip holds one track per requested skeleton bone index, in the order they are provided.
+ * Bones are in local space unless component space is requested, their parents are then decompressed as well.
+ * Bones without a track use the reference pose, or the identity for additive anim sequences.
+ *
+ * Returns false if the anim sequence isn't compressed with ACL, has no skeleton, or a bone index is invalid.
+ */
+ACLPLUGIN_API bool DecompressClipBones(const UAnimSequence& AnimSeq, TArrayView<const int32> BoneIndices, FACLDecompressedClip& OutClip, int32 FirstFrame = 0, int32 NumFrames = INDEX_NONE, bool bComponentSpace = false, bool bParallel = false);
@@ -0,0 +1,40 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+/** The quality at which ACL anim sequences are decompressed, lower qualities decode faster. */
+enum class EACLDecompressionQuality : uint8
+{
+	/** Interpolates between the two samples surrounding the sample time. */
+	Full,
+
+	/** Snaps to the nearest sample and decodes a single keyframe. */
+	NearestKey,
+
+	/** Snaps to every other sample, the pose updates at half the sample rate and a single keyframe is decoded. */
+	HalfRate,
+};
+
+/*
+ * Overrides the decompression quality of every ACL anim sequence decompressed on the calling thread
+ * for the lifetime of the scope, typically around the evaluation of a distant instance.
+ * Scopes can be nested, the previous quality is restored when the scope ends.
+ * Sequences that use the step interpolation always decode a single keyframe.
+ */
+class ACLPLUGIN_API FACLScopedDecompressionQuality
+{
+public:
+	explicit FACLScopedDecompressionQuality(EACLDecompressionQuality Quality);
+	~FACLScopedDecompressionQuality();
+
+	/** Returns the decompression quality used by the calling thread. */
+	static EACLDecompressionQuality GetCurrent();
+
+private:
+	FACLScopedDecompressionQuality(const FACLScopedDecompressionQuality&) = delete;
+	FACLScopedDecompressionQuality& operator=(const FACLScopedDecompressionQuality&) = delete;
+
+	EACLDecompressionQuality PreviousQuality;
+};
@@ -1,3 +1,4 @@
+import gzip
 import multiprocessing
 import numpy
 import os
@@ -22,6 +23,7 @@ def parse_argv():
 	options['csv_summary'] = False
 	options['csv_error'] = False
 	options['csv_kr'] = False
+	options['csv_sweep'] = False
 	options['num_threads'] = 1
 
 	for i in range(1, len(sys.argv)):
@@ -48,6 +50,9 @@ def parse_argv():
 		if value == '-csv_kr':
 			options['csv_kr'] = True
 
+		if value == '-csv_sweep':
+			options['csv_sweep'] = True
+
 		if value.startswith('-parallel='):
 			options['num_threads'] = int(value[len('-parallel='):].replace('"', ''))
 
@@ -95,7 +100,7 @@ def parse_argv():
 	return options
 
 def print_usage():
-	print('Usage: python stat_parser.py [-stats=<path to input directory for stats>] [-acl=<path to acl stats>] [-ue4=<path to ue4 stats>] [-csv_summary] [-csv_error] [-csv_kr] [-parallel=<num threads>]')
+	print('Usage: python stat_parser.py [-stats=<path to input directory for stats>] [-acl=<path to acl stats>] [-ue4=<path to ue4 stats>] [-csv_summary] [-csv_error] [-csv_kr] [-csv_sweep] [-parallel=<num threads>]')
 
 def bytes_to_mb(size_in_bytes):
 	return size_in_bytes / (1024.0 * 1024.0)
@@ -219,6 +224,56 @@ def output_csv_kr(stat_dir, clip_drop_rates, pose_drop_rates, track_drop_rates):
 
 	file.close()
 
+def get_sweep_key(entry):
+	return (entry['compression_level'], float(entry['error_threshold']), float(entry['virtual_vertex_distance']), int(entry['ideal_num_key_frames_per_segment']), int(entry['max_num_key_frames_per_segment']))
+
+def aggregate_sweep(merged_stats):
+	# Only settings that compressed every clip are comparable
+	sweep_results = {}
+	num_sweep_clips = 0
+	for (stat_acl, _) in merged_stats:
+		if not 'ue4_acl_sweep' in stat_acl:
+			continue
+
+		num_sweep_clips += 1
+		for entry in stat_acl['ue4_acl_sweep']:
+			key = get_sweep_key(entry)
+			if not key in sweep_results:
+				sweep_results[key] = { 'total_compressed_size': 0, 'max_error': 0.0, 'total_compression_time': 0.0, 'total_decompression_time_ns': 0.0, 'num_clips': 0 }
+
+			result = sweep_results[key]
+			result['total_compressed_size'] += int(entry['compressed_size'])
+			result['max_error'] = max(result['max_error'], float(entry['max_error']))
+			result['total_compression_time'] += float(entry['compression_time'])
+			result['total_decompression_time_ns'] += float(entry['decompression_time_ns'])
+			result['num_clips'] += 1
+
+	return { key: result for (key, result) in sweep_results.items() if result['num_clips'] == num_sweep_clips }
+
+def get_sweep_pareto_front(sweep_results):
+	def dominates(lhs, rhs):
+		lhs_values = (lhs['total_compressed_size'], lhs['max_error'], lhs['total_decompression_time_ns'])
+		rhs_values = (rhs['total_compressed_size'], rhs['max_error'], rhs['total_decompression_time_ns'])
+		return all(l <= r for (l, r) in zip(lhs_values, rhs_values)) and any(l < r for (l, r) in zip(lhs_values, rhs_values))
+
+	front = [ (key, result) for (key, result) in sweep_results.items() if not any(dominates(other, result) for other in sweep_results.values()) ]
+	front.sort(key=lambda entry: entry[1]['total_compressed_size'])
+	return front
+
+def output_csv_sweep(stat_dir, sweep_results, pareto_front):
+	csv_filename = os.path.join(stat_dir, 'stats_sweep.csv')
+	print('Generating CSV file {} ...'.format(csv_filename))
+	file = open(csv_filename, 'w')
+
+	print('Compression Level, Error Threshold, Virtual Vertex Distance, Ideal Segment Size, Max Segment Size, Compressed Size, Max Error, Compression Time, Decompression Time (ns), Pareto Optimal', file = file)
+
+	pareto_keys = set([key for (key, _) in pareto_front])
+	for (key, result) in sweep_results.items():
+		level, threshold, distance, ideal_size, max_size = key
+		print('{}, {}, {}, {}, {}, {}, {}, {}, {}, {}'.format(level, threshold, distance, ideal_size, max_size, result['total_compressed_size'], result['max_error'], result['total_compression_time'], result['total_decompression_time_ns'], key in pareto_keys), file = file)
+
+	file.close()
+
 def print_progress(iteration, total, prefix='', suffix='', decimals = 1, bar_length = 40):
 	# Taken from https://stackoverflow.com/questions/3173320/text-progress-bar-in-the-console
 	# With minor tweaks
@@ -293,6 +348,31 @@ def append_stats(permutation, clip_stats, run_stats, aggregate_results):
 		permutation_stats['worst_error'] = run_stats['acl_max_error']
 		permutation_stats['worst_entry'] = clip_stats
 
+def get_binary_error_filename(stat_filename):
+	return stat_filename.replace('.gz', '').replace('_stats.sjson', '_error.bin')
+
+def read_binary_error_stats(filename):
+	# Binary error stats written by the commandlet with -binary, see FACLBinaryErrorStatsWriter
+	header = numpy.memmap(filename, dtype='<u4', mode='r', offset=0, shape=(4,))
+	tag, version, num_sections, _ = header
+	if tag != 0x454C4341 or version != 1:
+		print('Unsupported binary error stats file: {}'.format(filename))
+		return {}
+
+	section_dtype = numpy.dtype([('name', 'S32'), ('num_samples', '<u4'), ('num_bones', '<u4'), ('offset', '<u8')])
+	sections = numpy.memmap(filename, dtype=section_dtype, mode='r', offset=16, shape=(int(num_sections),))
+
+	errors = {}
+	for section in sections:
+		name = section['name'].decode('ascii')
+		shape = (int(section['num_samples']), int(section['num_bones']))
+		if shape[0] * shape[1] == 0:
+			errors[name] = numpy.zeros(shape, dtype=numpy.float32)
+		else:
+			errors[name] = numpy.memmap(filename, dtype='<f4', mode='r', offset=int(section['offset']), shape=shape)
+
+	return errors
+
 def do_parse_stats(options, stat_queue, result_queue):
 	try:
 		stats = []
@@ -315,7 +395,9 @@ def do_parse_stats(options, stat_queue, result_queue):
 			else:
 				filename = stat_filename
 
-			with open(filename, 'r') as file:
+			# Stats can optionally be gzip compressed by the commandlet
+			open_stat_file = gzip.open if filename.endswith('.gz') else open
+			with open_stat_file(filename, 'rt') as file:
 				try:
 					file_data = sjson.loads(file.read())
 					if 'error' in file_data:
@@ -323,18 +405,24 @@ def do_parse_stats(options, stat_queue, result_queue):
 						continue
 
 					file_data['filename'] = stat_filename
-					file_data['clip_name'] = os.path.splitext(os.path.basename(stat_filename))[0].replace('_stats', '')
+					file_data['clip_name'] = os.path.basename(stat_filename).replace('.gz', '').replace('_stats.sjson', '')
+
+					# The exhaustive error can optionally live in a binary file next to the stats
+					binary_error_filename = get_binary_error_filename(filename)
+					if os.path.exists(binary_error_filename):
+						for (run_name, run_errors) in read_binary_error_stats(binary_error_filename).items():
+							if run_name in file_data:
+								# Copy out of the memory mapped file so the data can be sent back to the main process
+								file_data[run_name]['error_per_frame_and_bone'] = numpy.array(run_errors)
 
 					if not options['csv_error']:
 						# The sjson lib doesn't always return numbers as floats, sometimes as int but numpy doesn't like that
 						if 'ue4_acl' in file_data and 'error_per_frame_and_bone' in file_data['ue4_acl']:
-							for frame_error_values in file_data['ue4_acl']['error_per_frame_and_bone']:
-								acl_error_values.extend([float(v) for v in frame_error_values])
+							acl_error_values.append(numpy.array(file_data['ue4_acl']['error_per_frame_and_bone'], dtype=numpy.float64).ravel())
 							file_data['ue4_acl']['error_per_frame_and_bone'] = []
 
 						if 'ue4_auto' in file_data and 'error_per_frame_and_bone' in file_data['ue4_auto']:
-							for frame_error_values in file_data['ue4_auto']['error_per_frame_and_bone']:
-								ue4_error_values.extend([float(v) for v in frame_error_values])
+							ue4_error_values.append(numpy.array(file_data['ue4_auto']['error_per_frame_and_bone'], dtype=numpy.float64).ravel())
 							file_data['ue4_auto']['error_per_frame_and_bone'] = []
 
 					if 'ue4_acl' in file_data:
@@ -363,8 +451,8 @@ def do_parse_stats(options, stat_queue, result_queue):
 
 		results = {}
 		results['stats'] = stats
-		results['acl_error_values'] = acl_error_values
-		results['ue4_error_values'] = ue4_error_values
+		results['acl_error_values'] = numpy.concatenate(acl_error_values) if len(acl_error_values) > 0 else []
+		results['ue4_error_values'] = numpy.concatenate(ue4_error_values) if len(ue4_error_values) > 0 else []
 		results['ue4_keyreduction_data'] = ue4_keyreduction_data
 		results['acl_compression_times'] = acl_compression_times
 		results['ue4_compression_times'] = ue4_compression_times
@@ -419,6 +507,9 @@ def parallel_parse_stats(options, stat_files, label):
 
 	return stats
 
+def is_stat_file(filename):
+	return filename.endswith('.sjson') or filename.endswith('.sjson.gz')
+
 def get_stat_files(options):
 	if options['dual_stat_inputs']:
 		acl_stat_files = []
@@ -426,7 +517,7 @@ def get_stat_files(options):
 
 		for (dirpath, dirnames, filenames) in os.walk(options['acl_stats']):
 			for filename in filenames:
-				if not filename.endswith('.sjson'):
+				if not is_stat_file(filename):
 					continue
 
 				stat_filename = os.path.join(dirpath, filename)
@@ -434,7 +525,7 @@ def get_stat_files(options):
 
 		for (dirpath, dirnames, filenames) in os.walk(options['ue4_stats']):
 			for filename in filenames:
-				if not filename.endswith('.sjson'):
+				if not is_stat_file(filename):
 					continue
 
 				stat_filename = os.path.join(dirpath, filename)
@@ -452,7 +543,7 @@ def get_stat_files(options):
 
 		for (dirpath, dirnames, filenames) in os.walk(options['stats']):
 			for filename in filenames:
-				if not filename.endswith('.sjson'):
+				if not is_stat_file(filename):
 					continue
 
 				stat_filename = os.path.join(dirpath, filename)
@@ -525,6 +616,12 @@ if __name__ == "__main__":
 	if options['csv_kr'] and len(clip_drop_rates) > 0:
 		output_csv_kr(os.getcwd(), clip_drop_rates, pose_drop_rates, track_drop_rates)
 
+	sweep_results = aggregate_sweep(merged_stats)
+	sweep_pareto_front = get_sweep_pareto_front(sweep_results)
+
+	if options['csv_sweep'] and len(sweep_results) > 0:
+		output_csv_sweep(os.getcwd(), sweep_results, sweep_pareto_front)
+
 	print()
 	print('Stats per run type:')
 	aggregate_results = {}
@@ -533,6 +630,7 @@ if __name__ == "__main__":
 	num_acl_speed_wins = 0
 	num_acl_wins = 0
 	num_acl_auto_wins = 0
+	acl_size_breakdown = {}
 	for (stat_acl, stat_auto) in merged_stats:
 		if 'ue4_auto' in stat_auto:
 			ue4_auto = stat_auto['ue4_auto']
@@ -544,6 +642,11 @@ if __name__ == "__main__":
 			ue4_acl['desc'] = ue4_acl['algorithm_name']
 			append_stats('ue4_acl', stat_acl, ue4_acl, aggregate_results)
 
+			if 'size_breakdown' in ue4_acl:
+				for (key, value) in ue4_acl['size_breakdown'].items():
+					if key.endswith('_size'):
+						acl_size_breakdown[key] = acl_size_breakdown.get(key, 0) + int(value)
+
 		if 'ue4_keyreduction' in stat_acl:
 			ue4_keyreduction = stat_acl['ue4_keyreduction']
 			ue4_keyreduction['desc'] = ue4_keyreduction['algorithm_name']
@@ -603,6 +706,12 @@ if __name__ == "__main__":
 		if len(acl_error_values) > 0:
 			print('Bone error 99th percentile: {:.4f}'.format(numpy.percentile(acl_error_values, 99.0)))
 			print('Error threshold percentile rank: {:.2f} (0.01)'.format(percentile_rank(acl_error_values, 0.01)))
+		if 'total_size' in acl_size_breakdown and acl_size_breakdown['total_size'] > 0:
+			total_size = acl_size_breakdown['total_size']
+			print('Size breakdown:')
+			for (key, value) in acl_size_breakdown.items():
+				if key != 'total_size':
+					print('    {}: {:.2f} MB ({:.2f} %)'.format(key.replace('_size', ''), bytes_to_mb(value), float(value) / float(total_size) * 100.0))
 		print()
 
 	if 'ue4_keyreduction' in aggregate_results:
@@ -625,6 +734,13 @@ if __name__ == "__main__":
 	print('ACL was smaller, better, faster for {} clips ({:.2f} %)'.format(num_acl_wins, float(num_acl_wins) / num_clips * 100.0))
 	print('ACL won with simulated auto {} clips ({:.2f} %)'.format(num_acl_auto_wins, float(num_acl_auto_wins) / num_clips * 100.0))
 
+	if len(sweep_pareto_front) > 0:
+		print()
+		print('ACL settings sweep Pareto front (size, max error, decompression time):')
+		for (key, result) in sweep_pareto_front:
+			level, threshold, distance, ideal_size, max_size = key
+			print('{} threshold {} distance {} segments {}/{}: Compressed {:.2f} MB, Max error {:.4f}, Pose decompression {:.2f} us (summed over clips)'.format(level, threshold, distance, ideal_size, max_size, bytes_to_mb(result['total_compressed_size']), result['max_error'], result['total_decompression_time_ns'] / 1.0e3))
+
 	if len(clip_drop_rates) > 0:
 		print()
 		print('Key reduction clip avg drop rate: {:.2f} %'.format(numpy.average(clip_drop_rates) * 100.0))